@@ -0,0 +1,113 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+"""Dynamic instruction counts of RVV kernels under qemu-riscv64.
+
+qemu's wall time says little about real hardware, but the number of retired
+instructions per launch tracks codegen changes (LMUL, blocking, fences)
+reliably, and sweeping VLEN shows whether a kernel actually scales with the
+vector length.
+"""
+
+import argparse
+import json
+from typing import Dict, List
+
+import numpy as np
+
+import tilelang
+import tilelang.language as T
+from tilelang.contrib import rvv
+
+
+def scale(M, N, dtype="float32"):
+
+    @T.prim_func
+    def main(
+            X: T.Tensor((M, N), dtype),
+            Y: T.Tensor((M, N), dtype),
+    ):
+        with T.Kernel(1, 1, is_cpu=True) as (bx, by):
+            X_shared = T.alloc_shared((M, N), dtype)
+            Y_shared = T.alloc_shared((M, N), dtype)
+            T.rvv_copy(X[0, 0], X_shared)
+            T.rvv_mul_C(Y_shared, X_shared, T.float32(2.0))
+            T.rvv_copy(Y_shared, Y[0, 0])
+
+    def inputs():
+        return [np.random.rand(M, N).astype(dtype), np.zeros((M, N), dtype=dtype)]
+
+    return main, inputs
+
+
+def matmul(M, N, K, dtype="float32"):
+
+    @T.prim_func
+    def main(
+            A: T.Tensor((M, K), dtype),
+            B: T.Tensor((K, N), dtype),
+            C: T.Tensor((M, N), dtype),
+    ):
+        with T.Kernel(1, 1, is_cpu=True) as (bx, by):
+            A_shared = T.alloc_shared((M, K), dtype)
+            B_shared = T.alloc_shared((K, N), dtype)
+            C_shared = T.alloc_shared((M, N), dtype)
+            T.rvv_copy(A[0, 0], A_shared)
+            T.rvv_copy(B[0, 0], B_shared)
+            T.rvv_fill(C_shared, T.float32(0))
+            T.rvv_gemm(A_shared, B_shared, C_shared)
+            T.rvv_copy(C_shared, C[0, 0])
+
+    def inputs():
+        return [
+            np.random.rand(M, K).astype(dtype),
+            np.random.rand(K, N).astype(dtype),
+            np.zeros((M, N), dtype=dtype),
+        ]
+
+    return main, inputs
+
+
+def get_kernels(args) -> Dict[str, tuple]:
+    return {
+        f"scale_{args.m}x{args.n}": scale(args.m, args.n),
+        f"matmul_{args.m}x{args.n}x{args.k}": matmul(args.m, args.n, args.k),
+    }
+
+
+def run(args) -> List[dict]:
+    results = []
+    for name, (func, make_inputs) in get_kernels(args).items():
+        if args.kernel and args.kernel not in name:
+            continue
+        artifact = tilelang.lower(func, target="rvv")
+        inputs = make_inputs()
+        for vlen in args.vlen:
+            if args.tune_vlen:
+                # size LMUL and tiles for the emulated VLEN
+                artifact = tilelang.lower(func, target=f"rvv -vlen={vlen}")
+            insns = rvv.insns_per_launch(artifact, inputs, vlen=vlen, repeats=args.repeats)
+            results.append(dict(name=name, vlen=vlen, insns_per_launch=insns))
+            print(f"{name:<28} vlen={vlen:<5} insns/launch={insns:,.0f}")
+    return results
+
+
+def get_parser():
+    parser = argparse.ArgumentParser(description="RVV dynamic instruction count benchmark")
+    parser.add_argument("--m", type=int, default=64)
+    parser.add_argument("--n", type=int, default=64)
+    parser.add_argument("--k", type=int, default=64)
+    parser.add_argument("--vlen", type=int, nargs="+", default=[128, 256, 512])
+    parser.add_argument("--repeats", type=int, default=4)
+    parser.add_argument(
+        "--tune-vlen", action="store_true", help="lower each kernel with rvv -vlen=<vlen>")
+    parser.add_argument("--kernel", type=str, default="", help="only run kernels matching this")
+    parser.add_argument("--json", type=str, default=None, help="write results to this file")
+    return parser
+
+
+if __name__ == "__main__":
+    args = get_parser().parse_args()
+    results = run(args)
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(results, f, indent=2)
@@ -0,0 +1,70 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+
+import argparse
+
+import tilelang
+import tilelang.language as T
+from tpu_bench_utils import add_common_args, bench_kernel, enable_emulator_profile, report
+
+
+def embedding(select_num, inner_num, index_num, dtype="float16", index_dtype="uint16"):
+
+    @T.prim_func
+    def main(
+            output: T.Tensor((index_num, inner_num), dtype),
+            params: T.Tensor((select_num, inner_num), dtype),
+            indices: T.Tensor((index_num, 1), index_dtype),
+    ):
+        params_shared = T.alloc_shared((select_num, inner_num), dtype)
+        indices_shared = T.alloc_shared((index_num, 1), index_dtype)
+        output_shared = T.alloc_shared((index_num, inner_num), dtype)
+        T.ppl_copy(params, params_shared)
+        T.ppl_copy(indices, indices_shared)
+        T.ppl_fill(output_shared, T.float32(0))
+        T.ppl_embedding(output_shared, params_shared, indices_shared, T.int32(1),
+                        T.int32(inner_num), T.int32(select_num), T.int32(index_num))
+        T.ppl_copy(output_shared, output)
+
+    return main
+
+
+def run(args):
+    import torch
+    import torch_tpu  # noqa: F401
+
+    func = embedding(args.vocab, args.dim, args.tokens)
+    kernel = tilelang.compile(func, target="tpu", out_idx=[0])
+    device = "tpu:0"
+    output = torch.empty((args.tokens, args.dim), device=device, dtype=torch.float16)
+    params = torch.rand((args.vocab, args.dim), device=device, dtype=torch.float16)
+    index_cpu = torch.randint(0, args.vocab, (args.tokens, 1), dtype=torch.int32)
+    indices = index_cpu.to(torch.int16).to(device)
+
+    def ref_program(params, indices):
+        return params[index_cpu.view(-1).long()]
+
+    return bench_kernel(
+        "embedding",
+        dict(vocab=args.vocab, dim=args.dim, tokens=args.tokens),
+        kernel[(1,)], [output, params, indices],
+        ref_program=ref_program,
+        out_idx=0,
+        warmup=args.warmup,
+        rep=args.rep,
+        verbose=args.verbose)
+
+
+def get_parser():
+    parser = argparse.ArgumentParser(description="TPU emulator embedding gather benchmark")
+    # the whole table is staged in local memory, keep vocab * dim within one NPU slice
+    parser.add_argument("--vocab", type=int, default=1024)
+    parser.add_argument("--dim", type=int, default=128)
+    parser.add_argument("--tokens", type=int, default=64)
+    return add_common_args(parser)
+
+
+if __name__ == "__main__":
+    enable_emulator_profile()
+    args = get_parser().parse_args()
+    report([run(args)], args.json)
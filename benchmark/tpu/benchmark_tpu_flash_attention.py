@@ -0,0 +1,125 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+
+import argparse
+
+import tilelang
+import tilelang.language as T
+from tpu_bench_utils import add_common_args, bench_kernel, enable_emulator_profile, report
+
+
+def ref_program(Q, K, V):
+    import torch
+    dim = Q.size(-1)
+    scores = torch.einsum("bqhd,bkhd->bhqk", Q, K) / dim**0.5
+    attention = torch.softmax(scores, dim=-1)
+    return torch.einsum("bhqk,bkhd->bqhd", attention, V)
+
+
+def flashattn(batch, heads, seq_len, dim, block_M, block_N, num_stages):
+    scale = (1.0 / dim)**0.5 * 1.44269504  # log2(e)
+    shape = [batch, seq_len, heads, dim]
+    dtype = "float16"
+    accum_dtype = "float"
+
+    @T.prim_func
+    def main(
+            Q: T.Tensor(shape, dtype),
+            K: T.Tensor(shape, dtype),
+            V: T.Tensor(shape, dtype),
+            Output: T.Tensor(shape, dtype),
+    ):
+        with T.Kernel(T.ceildiv(seq_len, block_M), heads, batch, is_cpu=True) as (bx, by, bz):
+            Q_shared = T.alloc_shared([block_M, dim], dtype)
+            K_shared = T.alloc_shared([block_N, dim], dtype)
+            V_shared = T.alloc_shared([block_N, dim], dtype)
+            O_shared = T.alloc_shared([block_M, dim], dtype)
+            acc_s = T.alloc_shared([block_M, block_N], accum_dtype)
+            acc_s_cast = T.alloc_shared([block_M, block_N], dtype)
+            acc_o = T.alloc_shared([block_M, dim], accum_dtype)
+            scores_max = T.alloc_shared([block_M, 1], accum_dtype)
+            scores_max_prev = T.alloc_shared([block_M, 1], accum_dtype)
+            scores_scale = T.alloc_shared([block_M, 1], accum_dtype)
+            scores_sum = T.alloc_shared([block_M, 1], accum_dtype)
+            logsum = T.alloc_shared([block_M, 1], accum_dtype)
+            work0 = T.alloc_shared([block_M, 1], accum_dtype)
+            work1 = T.alloc_shared([block_M, 1], accum_dtype)
+            work0_1 = T.alloc_shared([block_M, block_N], accum_dtype)
+            work1_1 = T.alloc_shared([block_M, block_N], accum_dtype)
+            coeff = T.alloc_shared([64, 32], accum_dtype)  # npu number is 64
+            table = T.alloc_shared([64, 192], accum_dtype)
+
+            T.ppl_copy(Q[bz, bx * block_M:(bx + 1) * block_M, by, :], Q_shared)
+            T.ppl_fill(acc_o, T.float32(0))
+            T.ppl_fill(logsum, T.float32(0))
+            T.ppl_fill(scores_max, -T.infinity(accum_dtype))
+
+            for k in T.Pipelined(T.ceildiv(seq_len, block_N), num_stages=num_stages):
+                T.ppl_copy(K[bz, k * block_N:(k + 1) * block_N, by, :], K_shared)
+                T.ppl_fill(acc_s, T.float32(0))
+                T.ppl_gemm(Q_shared, K_shared, acc_s, transpose_B=True)
+
+                T.ppl_copy(scores_max, scores_max_prev)
+                T.ppl_fill(scores_max, -T.infinity(accum_dtype))
+                T.ppl_reduce_max(acc_s, scores_max, dim=1, clear=False)
+                T.ppl_subtract(scores_scale, scores_max_prev, scores_max)
+                T.ppl_mul_C(scores_scale, scores_scale, scale)
+                T.ppl_exp2(scores_scale, work0, work1, coeff, table)
+                T.ppl_subtract(acc_s, acc_s, scores_max)
+                T.ppl_mul_C(acc_s, acc_s, scale)
+                T.ppl_exp2(acc_s, work0_1, work1_1, coeff, table)
+                T.ppl_reduce_sum(acc_s, scores_sum, dim=1)
+                T.ppl_mul(logsum, logsum, scores_scale)
+                T.ppl_add(logsum, logsum, scores_sum)
+                T.ppl_copy(acc_s, acc_s_cast)
+
+                T.ppl_mul(acc_o, acc_o, scores_scale)
+                T.ppl_copy(V[bz, k * block_N:(k + 1) * block_N, by, :], V_shared)
+                T.ppl_gemm(acc_s_cast, V_shared, acc_o)
+            T.ppl_div(acc_o, acc_o, logsum)
+            T.ppl_copy(acc_o, O_shared)
+            T.ppl_copy(O_shared, Output[bz, bx * block_M:(bx + 1) * block_M, by, :])
+
+    return main
+
+
+def run(args):
+    import torch
+    import torch_tpu  # noqa: F401
+
+    func = flashattn(args.batch, args.heads, args.seq_len, args.dim, args.block_m, args.block_n,
+                     args.num_stages)
+    kernel = tilelang.compile(func, target="tpu", out_idx=[-1])
+    device = "tpu:0"
+    shape = (args.batch, args.seq_len, args.heads, args.dim)
+    Q = torch.randn(shape, device=device, dtype=torch.float16)
+    K = torch.randn(shape, device=device, dtype=torch.float16)
+    V = torch.randn(shape, device=device, dtype=torch.float16)
+    O = torch.empty(shape, device=device, dtype=torch.float16)
+    return bench_kernel(
+        "flash_attention",
+        dict(batch=args.batch, heads=args.heads, seq_len=args.seq_len, dim=args.dim,
+             block_M=args.block_m, block_N=args.block_n, num_stages=args.num_stages),
+        kernel[(1,)], [Q, K, V, O],
+        ref_program=ref_program,
+        warmup=args.warmup,
+        rep=args.rep,
+        verbose=args.verbose)
+
+
+def get_parser():
+    parser = argparse.ArgumentParser(description="TPU emulator flash attention benchmark")
+    parser.add_argument("--batch", type=int, default=1)
+    parser.add_argument("--heads", type=int, default=8)
+    parser.add_argument("--seq_len", type=int, default=512)
+    parser.add_argument("--dim", type=int, default=64)
+    parser.add_argument("--block_m", type=int, default=64)
+    parser.add_argument("--block_n", type=int, default=64)
+    parser.add_argument("--num_stages", type=int, default=0)
+    return add_common_args(parser)
+
+
+if __name__ == "__main__":
+    enable_emulator_profile()
+    args = get_parser().parse_args()
+    report([run(args)], args.json)
@@ -0,0 +1,78 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+
+import argparse
+
+import tilelang
+import tilelang.language as T
+from tpu_bench_utils import add_common_args, bench_kernel, enable_emulator_profile, report
+
+
+def ref_program(A, B, offsets):
+    import torch
+    C = torch.empty((A.shape[0], B.shape[2]), dtype=torch.float32, device=A.device)
+    for e in range(B.shape[0]):
+        lo, hi = int(offsets[e]), int(offsets[e + 1])
+        C[lo:hi] = A[lo:hi].float() @ B[e].float()
+    return C
+
+
+def grouped_gemm(total_M, N, K, num_experts, block_M, block_N, block_K, dtype="float16"):
+
+    @T.prim_func
+    def main(
+            A: T.Tensor((total_M, K), dtype),
+            B: T.Tensor((num_experts, K, N), dtype),
+            offsets: T.Tensor((num_experts + 1,), "int32"),
+            C: T.Tensor((total_M, N), "float32"),
+    ):
+        with T.Kernel(1, is_cpu=True) as (bx,):
+            T.ppl_grouped_gemm(A, B, C, offsets, block_M, block_N, block_K)
+
+    return main
+
+
+def run(args):
+    import torch
+    import torch_tpu  # noqa: F401
+
+    func = grouped_gemm(args.tokens, args.n, args.k, args.experts, args.block_m, args.block_n,
+                        args.block_k)
+    kernel = tilelang.compile(func, target="tpu", out_idx=[-1])
+    device = "tpu:0"
+    # skewed routing: a few hot experts, some without tokens
+    weights = torch.tensor([2.0**(-(e % 4)) if e % 5 else 0.0 for e in range(args.experts)])
+    counts = (weights / weights.sum() * args.tokens).floor().to(torch.int32)
+    counts[0] += args.tokens - int(counts.sum())
+    offsets = torch.zeros(args.experts + 1, dtype=torch.int32)
+    offsets[1:] = torch.cumsum(counts, 0)
+    A = torch.rand((args.tokens, args.k), device=device, dtype=torch.float16)
+    B = torch.rand((args.experts, args.k, args.n), device=device, dtype=torch.float16)
+    C = torch.empty((args.tokens, args.n), device=device, dtype=torch.float32)
+    return bench_kernel(
+        "grouped_gemm",
+        dict(tokens=args.tokens, N=args.n, K=args.k, experts=args.experts, block_M=args.block_m,
+             block_N=args.block_n, block_K=args.block_k),
+        kernel[(1,)], [A, B, offsets.to(device), C],
+        ref_program=ref_program,
+        warmup=args.warmup,
+        rep=args.rep,
+        verbose=args.verbose)
+
+
+def get_parser():
+    parser = argparse.ArgumentParser(description="TPU emulator grouped (MoE) GEMM benchmark")
+    parser.add_argument("--tokens", type=int, default=2048)
+    parser.add_argument("--n", type=int, default=512)
+    parser.add_argument("--k", type=int, default=512)
+    parser.add_argument("--experts", type=int, default=16)
+    parser.add_argument("--block_m", type=int, default=64)
+    parser.add_argument("--block_n", type=int, default=128)
+    parser.add_argument("--block_k", type=int, default=128)
+    return add_common_args(parser)
+
+
+if __name__ == "__main__":
+    enable_emulator_profile()
+    args = get_parser().parse_args()
+    report([run(args)], args.json)
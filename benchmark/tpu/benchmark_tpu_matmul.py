@@ -0,0 +1,75 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+
+import argparse
+
+import tilelang
+import tilelang.language as T
+from tpu_bench_utils import add_common_args, bench_kernel, enable_emulator_profile, report
+
+
+def ref_program(A, B):
+    return A @ B
+
+
+def matmul(M, N, K, block_M, block_N, block_K, num_stages, dtype="float16", accum_dtype="float32"):
+
+    @T.prim_func
+    def main(
+            A: T.Tensor((M, K), dtype),
+            B: T.Tensor((K, N), dtype),
+            C: T.Tensor((M, N), accum_dtype),
+    ):
+        with T.Kernel(T.ceildiv(N, block_N), T.ceildiv(M, block_M), is_cpu=True) as (bx, by):
+            A_shared = T.alloc_shared((block_M, block_K), dtype)
+            B_shared = T.alloc_shared((block_K, block_N), dtype)
+            C_shared = T.alloc_shared((block_M, block_N), accum_dtype)
+
+            T.ppl_fill(C_shared, T.float32(0))
+            for k in T.Pipelined(T.ceildiv(K, block_K), num_stages=num_stages):
+                T.ppl_copy(A[by * block_M, k * block_K], A_shared)
+                T.ppl_copy(B[k * block_K, bx * block_N], B_shared)
+                T.ppl_gemm(A_shared, B_shared, C_shared)
+
+            T.ppl_copy(C_shared, C[by * block_M, bx * block_N])
+
+    return main
+
+
+def run(args):
+    import torch
+    import torch_tpu  # noqa: F401
+
+    func = matmul(args.m, args.n, args.k, args.block_m, args.block_n, args.block_k, args.num_stages)
+    kernel = tilelang.compile(func, target="tpu", out_idx=[-1])
+    device = "tpu:0"
+    A = torch.rand((args.m, args.k), device=device, dtype=torch.float16)
+    B = torch.rand((args.k, args.n), device=device, dtype=torch.float16)
+    C = torch.empty((args.m, args.n), device=device, dtype=torch.float32)
+    return bench_kernel(
+        "matmul",
+        dict(M=args.m, N=args.n, K=args.k, block_M=args.block_m, block_N=args.block_n,
+             block_K=args.block_k, num_stages=args.num_stages),
+        kernel[(1,)], [A, B, C],
+        ref_program=ref_program,
+        warmup=args.warmup,
+        rep=args.rep,
+        verbose=args.verbose)
+
+
+def get_parser():
+    parser = argparse.ArgumentParser(description="TPU emulator matmul benchmark")
+    parser.add_argument("--m", type=int, default=1024)
+    parser.add_argument("--n", type=int, default=1024)
+    parser.add_argument("--k", type=int, default=1024)
+    parser.add_argument("--block_m", type=int, default=128)
+    parser.add_argument("--block_n", type=int, default=128)
+    parser.add_argument("--block_k", type=int, default=128)
+    parser.add_argument("--num_stages", type=int, default=2)
+    return add_common_args(parser)
+
+
+if __name__ == "__main__":
+    enable_emulator_profile()
+    args = get_parser().parse_args()
+    report([run(args)], args.json)
@@ -0,0 +1,71 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+
+import argparse
+
+import tilelang
+import tilelang.language as T
+from tpu_bench_utils import add_common_args, bench_kernel, enable_emulator_profile, report
+
+
+def ref_sum(X):
+    return X.sum(dim=1, keepdim=True)
+
+
+def ref_max(X):
+    return X.max(dim=1, keepdim=True)[0]
+
+
+def reduce(M, N, block_M, op="sum", dtype="float32"):
+
+    @T.prim_func
+    def main(
+            X: T.Tensor((M, N), dtype),
+            Y: T.Tensor((M, 1), dtype),
+    ):
+        with T.Kernel(1, T.ceildiv(M, block_M), is_cpu=True) as (bx, by):
+            X_shared = T.alloc_shared((block_M, N), dtype)
+            Y_shared = T.alloc_shared((block_M, 1), dtype)
+            T.ppl_copy(X[by * block_M, 0], X_shared)
+            if op == "sum":
+                T.ppl_fill(Y_shared, T.float32(0))
+                T.ppl_reduce_sum(X_shared, Y_shared, 1)
+            else:
+                T.ppl_reduce_max(X_shared, Y_shared, 1, True)
+            T.ppl_copy(Y_shared, Y[by * block_M, 0])
+
+    return main
+
+
+def run(args):
+    import torch
+    import torch_tpu  # noqa: F401
+
+    func = reduce(args.m, args.n, args.block_m, args.op)
+    kernel = tilelang.compile(func, target="tpu", out_idx=[-1])
+    device = "tpu:0"
+    X = torch.rand((args.m, args.n), device=device)
+    Y = torch.empty((args.m, 1), device=device)
+    return bench_kernel(
+        f"reduce_{args.op}",
+        dict(M=args.m, N=args.n, block_M=args.block_m),
+        kernel[(1,)], [X, Y],
+        ref_program=ref_sum if args.op == "sum" else ref_max,
+        warmup=args.warmup,
+        rep=args.rep,
+        verbose=args.verbose)
+
+
+def get_parser():
+    parser = argparse.ArgumentParser(description="TPU emulator row reduction benchmark")
+    parser.add_argument("--m", type=int, default=4096)
+    parser.add_argument("--n", type=int, default=1024)
+    parser.add_argument("--block_m", type=int, default=512)
+    parser.add_argument("--op", type=str, default="sum", choices=["sum", "max"])
+    return add_common_args(parser)
+
+
+if __name__ == "__main__":
+    enable_emulator_profile()
+    args = get_parser().parse_args()
+    report([run(args)], args.json)
@@ -0,0 +1,67 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+
+import argparse
+
+import tilelang
+import tilelang.language as T
+from tpu_bench_utils import add_common_args, bench_kernel, enable_emulator_profile, report
+
+
+def ref_program(A):
+    return A * (A.pow(2).mean(dim=1, keepdim=True) + 1e-12).rsqrt()
+
+
+def rms_norm(M, N, block_M, dtype="float32"):
+
+    @T.prim_func
+    def main(A: T.Tensor((M, N), dtype), B: T.Tensor((M, N), dtype)):
+        reciprocal_N = T.float32(1.0 / N)
+
+        with T.Kernel(T.ceildiv(M, block_M), is_cpu=True) as (bx,):
+            A_shared = T.alloc_shared((block_M, N), dtype)
+            A_pow2 = T.alloc_shared((block_M, N), dtype)
+            A_powsum = T.alloc_shared((block_M, 1), dtype)
+            T.ppl_copy(A[bx * block_M:(bx + 1) * block_M, :], A_shared)
+            T.ppl_mul(A_pow2, A_shared, A_shared)
+            T.ppl_reduce_sum(A_pow2, A_powsum, dim=1)
+            T.ppl_mul_C(A_powsum, A_powsum, reciprocal_N)
+            T.ppl_add_C(A_powsum, A_powsum, T.float32(1e-12))
+            T.ppl_rsqrt(A_powsum, A_powsum)
+            T.ppl_mul(A_shared, A_shared, A_powsum)
+            T.ppl_copy(A_shared, B[bx * block_M:(bx + 1) * block_M, :])
+
+    return main
+
+
+def run(args):
+    import torch
+    import torch_tpu  # noqa: F401
+
+    func = rms_norm(args.m, args.n, args.block_m)
+    kernel = tilelang.compile(func, target="tpu", out_idx=[-1])
+    device = "tpu:0"
+    A = torch.rand((args.m, args.n), device=device)
+    B = torch.empty((args.m, args.n), device=device)
+    return bench_kernel(
+        "rms_norm",
+        dict(M=args.m, N=args.n, block_M=args.block_m),
+        kernel[(1,)], [A, B],
+        ref_program=ref_program,
+        warmup=args.warmup,
+        rep=args.rep,
+        verbose=args.verbose)
+
+
+def get_parser():
+    parser = argparse.ArgumentParser(description="TPU emulator RMSNorm benchmark")
+    parser.add_argument("--m", type=int, default=2048)
+    parser.add_argument("--n", type=int, default=2048)
+    parser.add_argument("--block_m", type=int, default=64)
+    return add_common_args(parser)
+
+
+if __name__ == "__main__":
+    enable_emulator_profile()
+    args = get_parser().parse_args()
+    report([run(args)], args.json)
@@ -0,0 +1,55 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+"""Run the whole TPU emulator benchmark suite and dump one JSON report.
+
+Example:
+    python benchmark_tpu_suite.py --json tpu_bench.json
+    python benchmark_tpu_suite.py --only matmul rms_norm
+"""
+
+import argparse
+import traceback
+
+from tpu_bench_utils import add_common_args, enable_emulator_profile, report
+
+import benchmark_tpu_embedding
+import benchmark_tpu_flash_attention
+import benchmark_tpu_grouped_gemm
+import benchmark_tpu_matmul
+import benchmark_tpu_reduce
+import benchmark_tpu_rms_norm
+
+SUITE = {
+    "matmul": benchmark_tpu_matmul,
+    "grouped_gemm": benchmark_tpu_grouped_gemm,
+    "reduce": benchmark_tpu_reduce,
+    "embedding": benchmark_tpu_embedding,
+    "rms_norm": benchmark_tpu_rms_norm,
+    "flash_attention": benchmark_tpu_flash_attention,
+}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="TPU emulator benchmark suite")
+    parser.add_argument("--only", nargs="*", default=list(SUITE), choices=list(SUITE))
+    add_common_args(parser)
+    args = parser.parse_args()
+
+    enable_emulator_profile()
+    results = []
+    for name in args.only:
+        module = SUITE[name]
+        # every case runs with its default (realistic) shape, only the timing knobs are shared
+        case_args = module.get_parser().parse_args([
+            "--warmup", str(args.warmup), "--rep", str(args.rep)
+        ] + (["--verbose"] if args.verbose else []))
+        try:
+            results.append(module.run(case_args))
+        except Exception:  # keep going so one broken lowering does not hide the others
+            print(f"[{name}] failed:")
+            traceback.print_exc()
+    report(results, args.json)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,217 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+"""Shared helpers for the TPU emulator benchmark suite.
+
+The tpuv7 runtime emulator prints one line per retired BDC/GDMA command when
+``ENABLE_PROFILE`` is set, e.g.::
+
+    [perf][info] [0] ---> bdc record #3, inst_id=4, thread_id=0, cycle=812, start=1.2us, ...
+    [perf][info] core 0: gdma record_num=96, max_record_num=1048576
+
+Those lines are written by the emulator's C runtime straight to the process
+file descriptors, so the helpers below capture fd 1/2 around a kernel launch
+and fold the records into per-engine totals.
+"""
+
+import json
+import os
+import re
+import sys
+import tempfile
+import time
+from contextlib import contextmanager
+from dataclasses import dataclass, field, asdict
+from typing import Callable, Dict, List, Optional, Sequence
+
+_RECORD_RE = re.compile(r"---> (?P<engine>bdc|gdma) record #(?P<idx>\d+), inst_id=(?P<inst>\d+), "
+                        r"thread_id=\d+, cycle=(?P<cycle>\d+), start=(?P<start>[-\d.]+)us, "
+                        r"end=(?P<end>[-\d.]+)us")
+_RECORD_NUM_RE = re.compile(r"core (?P<core>\d+): (?P<engine>bdc|gdma) record_num=(?P<num>\d+)")
+_HIDDEN_RE = re.compile(r"\.\.\. \((?P<num>\d+) (?P<engine>bdc|gdma) records are not shown\)")
+
+ENGINES = ("bdc", "gdma")
+
+
+@dataclass
+class EngineStats:
+    """Per-engine counters decoded from the emulator profile log."""
+    instructions: int = 0
+    cycles: int = 0
+    busy_us: float = 0.0
+    records_shown: int = 0
+    records_hidden: int = 0
+
+
+@dataclass
+class BenchResult:
+    name: str
+    shape: Dict[str, int]
+    wall_ms: float
+    wall_ms_min: float
+    repeats: int
+    max_abs_err: Optional[float] = None
+    engines: Dict[str, EngineStats] = field(default_factory=dict)
+
+    def to_dict(self) -> dict:
+        return asdict(self)
+
+
+def _merged_length(intervals: List[tuple]) -> float:
+    """Length of the union of [start, end) intervals, used as engine busy time."""
+    total = 0.0
+    cur_start = cur_end = None
+    for start, end in sorted(intervals):
+        if cur_end is None or start > cur_end:
+            if cur_end is not None:
+                total += cur_end - cur_start
+            cur_start, cur_end = start, end
+        else:
+            cur_end = max(cur_end, end)
+    if cur_end is not None:
+        total += cur_end - cur_start
+    return total
+
+
+def parse_emulator_profile(text: str) -> Dict[str, EngineStats]:
+    """Fold emulator ``[perf]`` lines into per-engine statistics.
+
+    ``instructions`` comes from the per-core ``record_num`` summary when present
+    (it counts records that were not printed); ``cycles`` and ``busy_us`` only
+    cover the printed records, ``records_hidden`` says how many were skipped.
+    """
+    stats = {engine: EngineStats() for engine in ENGINES}
+    intervals: Dict[str, List[tuple]] = {engine: [] for engine in ENGINES}
+    summary_num = {engine: 0 for engine in ENGINES}
+    for line in text.splitlines():
+        m = _RECORD_RE.search(line)
+        if m:
+            s = stats[m.group("engine")]
+            s.records_shown += 1
+            s.cycles += int(m.group("cycle"))
+            intervals[m.group("engine")].append((float(m.group("start")), float(m.group("end"))))
+            continue
+        m = _RECORD_NUM_RE.search(line)
+        if m:
+            summary_num[m.group("engine")] += int(m.group("num"))
+            continue
+        m = _HIDDEN_RE.search(line)
+        if m:
+            stats[m.group("engine")].records_hidden += int(m.group("num"))
+    for engine in ENGINES:
+        s = stats[engine]
+        s.busy_us = _merged_length(intervals[engine])
+        s.instructions = summary_num[engine] or (s.records_shown + s.records_hidden)
+    return stats
+
+
+@contextmanager
+def capture_native_output(echo: bool = False):
+    """Redirect the process-level stdout/stderr (fd 1 and 2) into a buffer.
+
+    Yields a list which receives the captured text once the block exits.
+    """
+    sys.stdout.flush()
+    sys.stderr.flush()
+    saved = [os.dup(1), os.dup(2)]
+    out: List[str] = []
+    with tempfile.TemporaryFile(mode="w+b") as tmp:
+        os.dup2(tmp.fileno(), 1)
+        os.dup2(tmp.fileno(), 2)
+        try:
+            yield out
+        finally:
+            sys.stdout.flush()
+            sys.stderr.flush()
+            os.dup2(saved[0], 1)
+            os.dup2(saved[1], 2)
+            for fd in saved:
+                os.close(fd)
+            tmp.seek(0)
+            out.append(tmp.read().decode(errors="replace"))
+            if echo:
+                sys.stdout.write(out[-1])
+
+
+def enable_emulator_profile():
+    """Must run before the TPU runtime is initialised (i.e. before ``import torch_tpu``)."""
+    os.environ.setdefault("ENABLE_PROFILE", "1")
+
+
+def _synchronize():
+    import torch
+    tpu = getattr(torch, "tpu", None)
+    if tpu is not None and hasattr(tpu, "synchronize"):
+        tpu.synchronize()
+
+
+def bench_kernel(name: str,
+                 shape: Dict[str, int],
+                 kernel: Callable,
+                 inputs: Sequence,
+                 ref_program: Optional[Callable] = None,
+                 out_idx: int = -1,
+                 warmup: int = 1,
+                 rep: int = 3,
+                 verbose: bool = False) -> BenchResult:
+    """Run ``kernel(*inputs)`` on the emulator and collect wall time plus engine counters.
+
+    Only the first timed launch is captured for profile decoding, so every repeat
+    does not multiply the size of the emulator log.
+    """
+    for _ in range(warmup):
+        kernel(*inputs)
+    _synchronize()
+
+    with capture_native_output(echo=verbose) as captured:
+        start = time.perf_counter()
+        kernel(*inputs)
+        _synchronize()
+        times = [time.perf_counter() - start]
+    engines = parse_emulator_profile(captured[0])
+
+    for _ in range(rep - 1):
+        start = time.perf_counter()
+        kernel(*inputs)
+        _synchronize()
+        times.append(time.perf_counter() - start)
+
+    max_abs_err = None
+    if ref_program is not None:
+        out_idx = out_idx % len(inputs)
+        ref_inputs = [t.cpu().float() for i, t in enumerate(inputs) if i != out_idx]
+        expected = ref_program(*ref_inputs)
+        got = inputs[out_idx].cpu().float()
+        max_abs_err = (got - expected).abs().max().item()
+
+    return BenchResult(
+        name=name,
+        shape=dict(shape),
+        wall_ms=1e3 * sum(times) / len(times),
+        wall_ms_min=1e3 * min(times),
+        repeats=len(times),
+        max_abs_err=max_abs_err,
+        engines=engines,
+    )
+
+
+def report(results: List[BenchResult], json_path: Optional[str] = None):
+    """Print a summary table and optionally dump all results as JSON."""
+    header = f"{'kernel':<18}{'wall(ms)':>12}{'bdc inst':>10}{'bdc cyc':>12}{'gdma inst':>11}{'gdma cyc':>12}"
+    print(header)
+    print("-" * len(header))
+    for r in results:
+        bdc, gdma = r.engines.get("bdc", EngineStats()), r.engines.get("gdma", EngineStats())
+        print(f"{r.name:<18}{r.wall_ms:>12.3f}{bdc.instructions:>10}{bdc.cycles:>12}"
+              f"{gdma.instructions:>11}{gdma.cycles:>12}")
+    if json_path:
+        with open(json_path, "w") as f:
+            json.dump([r.to_dict() for r in results], f, indent=2)
+        print(f"results written to {json_path}")
+
+
+def add_common_args(parser):
+    parser.add_argument("--warmup", type=int, default=1, help="untimed launches before measuring")
+    parser.add_argument("--rep", type=int, default=3, help="timed launches")
+    parser.add_argument("--json", type=str, default=None, help="write results to this JSON file")
+    parser.add_argument("--verbose", action="store_true", help="echo the emulator log")
+    return parser
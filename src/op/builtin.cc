@@ -20,6 +20,11 @@ namespace tvm {
 namespace tl {
 
 TVM_REGISTER_PASS_CONFIG_OPTION(kDisableTMALower, Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION(kPPLProfile, Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION(kPPLL2SramSize, Integer);
+TVM_REGISTER_PASS_CONFIG_OPTION(kRVVMinVLEN, Integer);
+TVM_REGISTER_PASS_CONFIG_OPTION(kRVVNumThreads, Integer);
+TVM_REGISTER_PASS_CONFIG_OPTION(kRVVSchedule, String);
 
 #define TIR_DEFINE_TL_BUILTIN(OpName)                                          \
   const Op &OpName() {                                                         \
@@ -17,6 +17,19 @@ namespace tvm {
 namespace tl {
 
 static constexpr const char *kDisableTMALower = "tl.disable_tma_lower";
+// Wrap every lowered ppl.* tile op with command-id markers in the PPL codegen.
+static constexpr const char *kPPLProfile = "tl.ppl_profile";
+// Bytes of L2 SRAM AddressAssign may place shared.l2/global.l2 buffers in.
+static constexpr const char *kPPLL2SramSize = "tl.ppl_l2_sram_size";
+// Minimum VLEN in bits the RVV codegen may assume when picking LMUL and tiles.
+static constexpr const char *kRVVMinVLEN = "tl.rvv_min_vlen";
+// Harts the RVV block grid is spread over, 0 for all of them, 1 for serial.
+static constexpr const char *kRVVNumThreads = "tl.rvv_num_threads";
+// OpenMP schedule of the RVV block grid, "static" or "dynamic".
+static constexpr const char *kRVVSchedule = "tl.rvv_schedule";
+// PrimFunc attr listing, per pipelined buffer, the data var names of its
+// versions, so AddressAssign can keep them in distinct banks.
+static constexpr const char *kPipelineVersions = "tl.pipeline_versions";
 
 /*!
  * \brief tvm intrinsics for TMADescriptor creation for tiled load
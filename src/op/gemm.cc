@@ -111,6 +111,23 @@ std::pair<int, int> Gemm::ComputeWarpPartition(int num_warps, Target target,
 }
 
 Stmt Gemm::Lower(const LowerArgs &T, arith::Analyzer *analyzer) const {
+  if (TargetIsCPU(T.target)) {
+    // the calling thread computes the whole tile, see tl_templates/cpu/gemm.h
+    ICHECK(A.scope() != "local.fragment" && B.scope() != "local.fragment")
+        << "CPU gemm expects row-major A and B tiles";
+    std::stringstream ss;
+    ss << "tl::cpu::gemm_ss<" << M << ", " << N << ", " << K << ", ";
+    ss << trans_A << ", " << trans_B << ", " << clear_accum << ">";
+    auto A_buffer = T.buffer_remap.count(A) ? T.buffer_remap[A] : A;
+    auto B_buffer = T.buffer_remap.count(B) ? T.buffer_remap[B] : B;
+    auto C_buffer = T.buffer_remap.count(C) ? T.buffer_remap[C] : C;
+    Array<PrimExpr> new_args;
+    new_args.push_back(StringImm(ss.str()));
+    new_args.push_back(A_buffer.access_ptr(1));
+    new_args.push_back(B_buffer.access_ptr(1));
+    new_args.push_back(C_buffer.access_ptr(3));
+    return Evaluate(Call(DataType::Handle(), builtin::call_extern(), new_args));
+  }
   int warp_size = 32;
   if (TargetIsCDNA(T.target)) {
     warp_size = 64;
@@ -161,6 +178,11 @@ LayoutMap Gemm::InferLayout(const LayoutInferArgs &T, InferLevel level) {
   if (completed_)
     return {};
   LayoutMap results;
+  if (TargetIsCPU(T.target)) {
+    // plain row-major tiles on one thread
+    completed_ = true;
+    return results;
+  }
   ICHECK(C.scope() == "local.fragment");
 
   if (TargetIsVolta(T.target)) {
@@ -23,25 +23,81 @@
 
  #include "codegen_ppl.h"
  #include <tvm/arith/analyzer.h>
+#include <tvm/arith/pattern.h>
  #include <tvm/runtime/registry.h>
+#include <tvm/tir/analysis.h>
 #include <tvm/tir/index_map.h>
  #include <tvm/tir/op.h>
  
  #include <cmath>
+ #include <iomanip>
  #include <string>
+ #include <tuple>
  #include <utility>
  #include <vector>
  
  #include "../op/builtin.h"
  #include "../op/bulk_copy.h"
  #include "../op/gemm.h"
+#include "../op/op.h"
  // #include "../../target/source/ptx.h"
  
  namespace tvm {
  namespace codegen {
- 
+
+// data_type_t enumerator of the TPU kernel API for a TIR dtype.
+static std::string PPLDataType(DataType t) {
+  if (t == DataType::Float(32))
+    return "DT_FP32";
+  if (t == DataType::Float(16))
+    return "DT_FP16";
+  if (t == DataType::BFloat(16))
+    return "DT_BFP16";
+  if (t == DataType::Int(8))
+    return "DT_INT8";
+  if (t == DataType::UInt(8))
+    return "DT_UINT8";
+  if (t == DataType::Int(16))
+    return "DT_INT16";
+  if (t == DataType::UInt(16))
+    return "DT_UINT16";
+  if (t == DataType::Int(32))
+    return "DT_INT32";
+  if (t == DataType::UInt(32))
+    return "DT_UINT32";
+  LOG(FATAL) << "Unsupported dtype for the PPL backend: " << t;
+  return "";
+}
+
+// L2 SRAM buffers live in system memory shared by all cores of the chip.
+static bool IsL2Scope(const std::string &scope) {
+  return scope == "shared.l2" || scope == "global.l2";
+}
+
+// scalar_t initializer holding \p value as dtype \p t.
+static std::string PPLScalar(DataType t, double value) {
+  std::ostringstream os;
+  if (t.is_float() && t.bits() == 32) {
+    os << "(scalar_t){.f32 = " << value << "}";
+  } else if (t.is_float() && t.bits() == 16) {
+    os << "(scalar_t){.f16 = " << value << "}";
+  } else if (t.is_bfloat16()) {
+    os << "(scalar_t){.bf16 = " << value << "}";
+  } else if (t.is_int()) {
+    os << "(scalar_t){.s" << t.bits() << " = " << static_cast<int64_t>(value)
+       << "}";
+  } else {
+    os << "(scalar_t){.u" << t.bits() << " = " << static_cast<uint64_t>(value)
+       << "}";
+  }
+  return os.str();
+}
+
 CodeGenTileLangPPL::CodeGenTileLangPPL() {
   restrict_keyword_ = "global_addr_t";
+  profile_ = transform::PassContext::Current()
+                 ->GetConfig<Bool>(tl::kPPLProfile, Bool(false))
+                 .value();
 }
  
 void CodeGenTileLangPPL::PrintFuncPrefix(
@@ -73,6 +129,81 @@ void CodeGenTileLangPPL::PrintFuncPrefix(
    PrimExpr threadIdx_z_ext = Integer(1);
  };
  
+// Collects the global/L2 tl.region operands of the ppl.copy and ppl.transpose
+// calls a loop body issues once per iteration, i.e. outside nested loops.
+class LoopCopyRegionCollector : public tir::StmtExprVisitor {
+public:
+  std::vector<const CallNode *> regions;
+
+private:
+  void VisitStmt_(const ForNode *op) final {}
+
+  void VisitExpr_(const CallNode *op) final {
+    const auto *name =
+        op->op.same_as(builtin::call_extern()) && !op->args.empty()
+            ? op->args[0].as<StringImmNode>()
+            : nullptr;
+    // a padded copy addresses its halo window itself
+    if (name && ((name->value == "ppl.copy" && op->args.size() == 3) ||
+                 name->value == "ppl.transpose")) {
+      for (int i : {1, 2}) {
+        const auto *region = op->args[i].as<CallNode>();
+        if (region && region->op.same_as(tl::RegionOp::Get())) {
+          regions.push_back(region);
+        }
+      }
+    }
+    StmtExprVisitor::VisitExpr_(op);
+  }
+};
+
+// Sorts the buffers the ppl calls of a loop body touch by DMA engine: global
+// to global copies and global fills run on the SDMA, everything else reaches
+// memory through the GDMA or the BDC.
+class LoopDMAAccessCollector : public tir::StmtExprVisitor {
+public:
+  std::unordered_set<std::string> sdma, other;
+
+private:
+  static bool IsGlobal(const std::string &scope) {
+    return scope == "global" || IsL2Scope(scope);
+  }
+
+  void VisitExpr_(const CallNode *op) final {
+    const auto *name =
+        op->op.same_as(builtin::call_extern()) && !op->args.empty()
+            ? op->args[0].as<StringImmNode>()
+            : nullptr;
+    if (!name || name->value.find("ppl.") != 0) {
+      StmtExprVisitor::VisitExpr_(op);
+      return;
+    }
+    std::vector<std::pair<std::string, std::string>> buffers;
+    for (size_t i = 1; i < op->args.size(); ++i) {
+      const auto *arg = op->args[i].as<CallNode>();
+      if (arg && arg->op.same_as(tl::RegionOp::Get())) {
+        Buffer buffer = arg->args[0].as<BufferLoadNode>()->buffer;
+        buffers.emplace_back(buffer->name, buffer.scope());
+      } else if (arg && arg->op.same_as(builtin::tvm_access_ptr())) {
+        const auto *var = arg->args[1].as<VarNode>();
+        const auto *ptr_type = var->type_annotation.as<PointerTypeNode>();
+        buffers.emplace_back(var->name_hint,
+                             ptr_type ? ptr_type->storage_scope : "");
+      }
+    }
+    bool on_sdma =
+        (name->value == "ppl.copy" && op->args.size() == 3 &&
+         buffers.size() == 2 && IsGlobal(buffers[0].second) &&
+         IsGlobal(buffers[1].second)) ||
+        (name->value == "ppl.fill" && !buffers.empty() &&
+         IsGlobal(buffers[0].second));
+    for (const auto &buffer : buffers) {
+      (on_sdma ? sdma : other).insert(buffer.first);
+    }
+    StmtExprVisitor::VisitExpr_(op);
+  }
+};
+
 void CodeGenTileLangPPL::PrintExtraAttrs(const PrimFunc &f, std::ostream &os) {}
  
  std::string CodeGenTileLangPPL::Finish() {
@@ -85,30 +216,291 @@ void CodeGenTileLangPPL::PrintExtraAttrs(const PrimFunc &f, std::ostream &os) {}
               << "    DT_INT8,    DT_UINT8,   DT_INT4,  DT_UINT4};\n"
               << "  return __dtype[type];\n"
               << "}\n\n";
+  if (profile_) {
+    // Every profiled op records the BDC/GDMA command ids issued between its
+    // begin and end marker; tilelang.profiler.ppl_profile joins the dumped
+    // ranges with the per-command cycles reported by the emulator/PMU.
+    decl_stream << "#include <stdio.h>\n"
+                << "#define __PPL_PROF_CAP 8192\n"
+                << "typedef struct {\n"
+                << "  unsigned int stmt;\n"
+                << "  unsigned int bd_begin, bd_end;\n"
+                << "  unsigned int gdma_begin, gdma_end;\n"
+                << "} __ppl_prof_record;\n"
+                << "static __ppl_prof_record __ppl_prof_buf[__PPL_PROF_CAP];\n"
+                << "static unsigned int __ppl_prof_num = 0;\n"
+                << "static unsigned int __ppl_prof_dropped = 0;\n"
+                << "static const char *__ppl_prof_stmts[] = {\n";
+    for (const auto &stmt : profile_stmts_) {
+      decl_stream << "  \"" << stmt << "\",\n";
+    }
+    decl_stream << "  0};\n"
+                << "static inline void __ppl_prof_begin(unsigned int stmt) {\n"
+                << "  CMD_ID_NODE node;\n"
+                << "  if (__ppl_prof_num >= __PPL_PROF_CAP) {\n"
+                << "    ++__ppl_prof_dropped;\n"
+                << "    return;\n"
+                << "  }\n"
+                << "  tpu_get_id_node(&node);\n"
+                << "  __ppl_prof_buf[__ppl_prof_num].stmt = stmt;\n"
+                << "  __ppl_prof_buf[__ppl_prof_num].bd_begin = "
+                   "node.bd_cmd_id;\n"
+                << "  __ppl_prof_buf[__ppl_prof_num].gdma_begin = "
+                   "node.gdma_cmd_id;\n"
+                << "}\n"
+                << "static inline void __ppl_prof_end(unsigned int stmt) {\n"
+                << "  CMD_ID_NODE node;\n"
+                << "  if (__ppl_prof_num >= __PPL_PROF_CAP) return;\n"
+                << "  tpu_get_id_node(&node);\n"
+                << "  __ppl_prof_buf[__ppl_prof_num].bd_end = node.bd_cmd_id;\n"
+                << "  __ppl_prof_buf[__ppl_prof_num].gdma_end = "
+                   "node.gdma_cmd_id;\n"
+                << "  ++__ppl_prof_num;\n"
+                << "}\n"
+                << "static void __ppl_prof_dump() {\n"
+                << "  for (unsigned int i = 0; i < __ppl_prof_num; ++i) {\n"
+                << "    __ppl_prof_record *r = &__ppl_prof_buf[i];\n"
+                << "    printf(\"[ppl_prof] stmt=%u bd=%u:%u gdma=%u:%u op=%s\\n\",\n"
+                << "           r->stmt, r->bd_begin, r->bd_end, r->gdma_begin,\n"
+                << "           r->gdma_end, __ppl_prof_stmts[r->stmt]);\n"
+                << "  }\n"
+                << "  printf(\"[ppl_prof] records=%u dropped=%u\\n\", "
+                   "__ppl_prof_num,\n"
+                << "         __ppl_prof_dropped);\n"
+                << "  __ppl_prof_num = 0;\n"
+                << "  __ppl_prof_dropped = 0;\n"
+                << "}\n\n";
+  }
+  if (grouped_gemm_) {
+    // A grouped GEMM runs ceil(rows_e / block_m) * n_tiles output tiles for
+    // every expert e, numbered expert by expert. Step s of a core computes
+    // the k-th block of its (s / k_tiles)-th tile, tiles are dealt out to the
+    // cores round robin.
+    decl_stream
+        << "typedef struct {\n"
+        << "  int expert, m0, rows, n0, cols, k, k0, ks;\n"
+        << "} __ppl_grouped_step;\n"
+        << "static int __ppl_grouped_tile_num(const int *offsets, int "
+           "num_experts,\n"
+        << "                                  int block_m, int n_tiles) {\n"
+        << "  int tiles = 0;\n"
+        << "  for (int e = 0; e < num_experts; ++e) {\n"
+        << "    int rows = offsets[e + 1] - offsets[e];\n"
+        << "    tiles += (rows + block_m - 1) / block_m * n_tiles;\n"
+        << "  }\n"
+        << "  return tiles;\n"
+        << "}\n"
+        << "static void __ppl_grouped_step_at(const int *offsets, int "
+           "num_experts,\n"
+        << "                                  int block_m, int block_n, int "
+           "block_k,\n"
+        << "                                  int N, int K, int tile, int k,\n"
+        << "                                  __ppl_grouped_step *st) {\n"
+        << "  int n_tiles = (N + block_n - 1) / block_n;\n"
+        << "  for (int e = 0; e < num_experts; ++e) {\n"
+        << "    int rows = offsets[e + 1] - offsets[e];\n"
+        << "    int tiles = (rows + block_m - 1) / block_m * n_tiles;\n"
+        << "    if (tile < tiles) {\n"
+        << "      st->expert = e;\n"
+        << "      st->m0 = offsets[e] + tile / n_tiles * block_m;\n"
+        << "      st->rows = MIN(block_m, offsets[e + 1] - st->m0);\n"
+        << "      st->n0 = tile % n_tiles * block_n;\n"
+        << "      st->cols = MIN(block_n, N - st->n0);\n"
+        << "      st->k = k;\n"
+        << "      st->k0 = k * block_k;\n"
+        << "      st->ks = MIN(block_k, K - st->k0);\n"
+        << "      return;\n"
+        << "    }\n"
+        << "    tile -= tiles;\n"
+        << "  }\n"
+        << "}\n\n";
+  }
+  if (collective_) {
+    // Collectives run a ring over the chips of the job on a 2D view of the
+    // tensor: `rows` rows of `w` elements, `row_stride` apart. Rank r owns
+    // rows chunk r; a reduce-scatter step sends chunk r-1-s to the next chip
+    // and reduces chunk r-2-s from the previous one into place, an
+    // all-gather step forwards chunk r-s. Only the CDMA engine is waited
+    // for, BDC/GDMA work issued earlier keeps running.
+    // The cmodel of one chip has no peer: the fake CDMA entry points stand
+    // in for the transfers there.
+    decl_stream
+        << "static void __ppl_cdma_chunk(int chunk, int world, int rows,\n"
+        << "                             int *begin, int *count) {\n"
+        << "  int size = (rows + world - 1) / world;\n"
+        << "  *begin = MIN(chunk * size, rows);\n"
+        << "  *count = MIN(size, rows - *begin);\n"
+        << "}\n"
+        << "static void __ppl_cdma_step(int send_chunk, int recv_chunk, int "
+           "opcode,\n"
+        << "                            u64 send_addr, u64 recv_addr, int "
+           "rows, int w,\n"
+        << "                            int row_stride, data_type_t dtype) {\n"
+        << "  int world = tpu_chip_num(), rank = tpu_rank();\n"
+        << "  int *chips = tpu_chip_map();\n"
+        << "  int self = chips[rank];\n"
+        << "  int next = chips[(rank + 1) % world];\n"
+        << "  int prev = chips[(rank + world - 1) % world];\n"
+        << "  int bytes = tpu_data_type_size(dtype);\n"
+        << "  int b, n;\n"
+        << "  __ppl_cdma_chunk(send_chunk, world, rows, &b, &n);\n"
+        << "  if (n > 0) {\n"
+        << "#if defined(__sg2260__) && defined(USING_CMODEL)\n"
+        << "    tpu_cdma_fake_p2p(next, send_addr + (u64)b * row_stride * "
+           "bytes, 1, n, 1,\n"
+        << "                      w, n * row_stride, row_stride, row_stride, "
+           "opcode, dtype);\n"
+        << "#else\n"
+        << "    tpu_cdma_send(next, self, send_addr + (u64)b * row_stride * "
+           "bytes, 1, n,\n"
+        << "                  1, w, n * row_stride, row_stride, row_stride, "
+           "opcode, dtype);\n"
+        << "#endif\n"
+        << "  }\n"
+        << "  __ppl_cdma_chunk(recv_chunk, world, rows, &b, &n);\n"
+        << "#if !(defined(__sg2260__) && defined(USING_CMODEL))\n"
+        << "  if (n > 0) {\n"
+        << "    u64 dst = recv_addr + (u64)b * row_stride * bytes;\n"
+        << "    tpu_cdma_recv(prev, self, dst, 1, n, 1, w, n * row_stride, "
+           "row_stride,\n"
+        << "                  row_stride, dst, opcode, dtype);\n"
+        << "  }\n"
+        << "#endif\n"
+        << "  tpu_cdma_poll();\n"
+        << "}\n"
+        << "static void __ppl_reduce_scatter(u64 addr, int rows, int w, int "
+           "row_stride,\n"
+        << "                                 int opcode, data_type_t dtype) "
+           "{\n"
+        << "  int world = tpu_chip_num(), rank = tpu_rank();\n"
+        << "  for (int s = 0; s + 1 < world; ++s) {\n"
+        << "    __ppl_cdma_step((rank + 2 * world - 1 - s) % world,\n"
+        << "                    (rank + 2 * world - 2 - s) % world, opcode, "
+           "addr, addr,\n"
+        << "                    rows, w, row_stride, dtype);\n"
+        << "  }\n"
+        << "}\n"
+        << "static void __ppl_all_gather(u64 addr, int rows, int w, int "
+           "row_stride,\n"
+        << "                             data_type_t dtype) {\n"
+        << "  int world = tpu_chip_num(), rank = tpu_rank();\n"
+        << "  for (int s = 0; s + 1 < world; ++s) {\n"
+        << "    __ppl_cdma_step((rank + world - s) % world,\n"
+        << "                    (rank + 2 * world - 1 - s) % world, "
+           "ALL_REDUCE_NOP, addr,\n"
+        << "                    addr, rows, w, row_stride, dtype);\n"
+        << "  }\n"
+        << "}\n\n";
+  }
      return CodeGenC::Finish();
  }
  
  /* no need to change */
 void CodeGenTileLangPPL::VisitStmt_(const tir::ForNode *op) {
  
-   if (op->kind == tir::ForKind::kUnrolled) {
-     PrintIndent();
-     stream << "#pragma unroll\n";
-   }
   std::string extent =
       PrintExpr(arith::Analyzer().Simplify(op->extent + op->min));
-   PrintIndent();
    std::string vid = AllocVarID(op->loop_var.get());
    std::string start = PrintExpr(op->min);
+  // Global tiles walked by the loop move by a constant stride, keep their
+  // byte offsets in induction variables advanced at the end of the body
+  // instead of rebuilding them from the indices in every iteration.
+  LoopCopyRegionCollector collector;
+  collector(op->body);
+  std::vector<std::pair<std::string, int64_t>> increments;
+  std::vector<std::tuple<std::string, PrimExpr, std::string>> offsets;
+  std::vector<const CallNode *> registered;
+  for (const CallNode *region : collector.regions) {
+    if (induction_offsets_.count(region)) {
+      continue;
+    }
+    tl::RegionOp copy(region->args, tl::BufferMap());
+    const Buffer &buffer = copy.GetBuffer();
+    auto ranges = copy.GetRanges();
+    if (!(buffer.scope() == "global" || IsL2Scope(buffer.scope())) ||
+        !buffer_stride.count(buffer->name) ||
+        (ranges.size() != 2 && ranges.size() != 4)) {
+      continue;
+    }
+    auto strides = buffer_stride[buffer->name];
+    std::vector<int> stride_map = ranges.size() == 2
+                                      ? std::vector<int>{1, 3}
+                                      : std::vector<int>{0, 1, 2, 3};
+    PrimExpr elem_offset = make_zero(ranges[0]->min.dtype());
+    for (size_t i = 0; i < ranges.size(); ++i) {
+      elem_offset = elem_offset + ranges[i]->min * strides[stride_map[i]];
+    }
+    auto linear = arith::DetectLinearEquation(elem_offset, {op->loop_var});
+    if (linear.size() != 2) {
+      continue;
+    }
+    const auto *coef = linear[0].as<IntImmNode>();
+    // the start offset is computed before the loop, it may only use values
+    // that are already bound there
+    if (!coef || coef->value == 0 ||
+        UsesVar(linear[1], [this](const VarNode *v) {
+          return !var_idmap_.count(v);
+        })) {
+      continue;
+    }
+    std::string offset_var;
+    for (const auto &[name, expr, var] : offsets) {
+      if (name == buffer->name && StructuralEqual()(expr, elem_offset)) {
+        offset_var = var;
+      }
+    }
+    if (offset_var.empty()) {
+      int64_t bytes = (buffer->dtype.bits() + 7) / 8;
+      offset_var = name_supply_->FreshName(buffer->name + "_offset");
+      PrimExpr init =
+          arith::Analyzer().Simplify(linear[1] + linear[0] * op->min);
+      PrintIndent();
+      stream << "long long " << offset_var << " = (long long)("
+             << PrintExpr(init) << ") * " << bytes << ";\n";
+      offsets.emplace_back(buffer->name, elem_offset, offset_var);
+      increments.emplace_back(offset_var, coef->value * bytes);
+    }
+    registered.push_back(region);
+    induction_offsets_[region] = offset_var;
+  }
+  if (op->kind == tir::ForKind::kUnrolled) {
+    PrintIndent();
+    stream << "#pragma unroll\n";
+  }
+   PrintIndent();
    stream << "for (";
    PrintType(op->loop_var.dtype(), stream);
   stream << ' ' << vid << " = " << start << "; " << vid << " < " << extent
          << "; ++" << vid << ") {\n";
    int for_scope = BeginScope();
    PrintStmt(op->body);
+  for (const auto &[offset_var, step] : increments) {
+    PrintIndent();
+    stream << offset_var << " += " << step << ";\n";
+  }
+  // The syncs above are placed for the order of the body text. A DMA command
+  // still running at the end of the body only needs a wait when the other
+  // engine touches its buffer again in the next iteration.
+  LoopDMAAccessCollector dma;
+  dma(op->body);
+  for (const std::string &name : dma.other) {
+    if (sdma_pending_.count(name)) {
+      SyncSDMA();
+      break;
+    }
+  }
+  for (const std::string &name : dma.sdma) {
+    if (gdma_pending_.count(name)) {
+      SyncGDMA();
+      break;
+    }
+  }
    this->EndScope(for_scope);
    PrintIndent();
    stream << "}\n";
+  for (const CallNode *region : registered) {
+    induction_offsets_.erase(region);
+  }
  }
  
 void CodeGenTileLangPPL::BindThreadIndex(const IterVar &iv) {
@@ -729,8 +1121,7 @@ void CodeGenTileLangPPL::VisitExpr_(const CallNode *op, std::ostream &os) {
       this->stream << src1 << "_stride.w = 0;\n";
       src1_stride << "&" << src1 << "_stride, ";
     } else if (src1_shape[1] == src0_shape[1]) {
-      src1_stride << "(" << src1 << ".default_stride ? NULL : &" << src1
-                  << ".stride), ";
+      src1_stride << StrideArg(src1) << ", ";
     }
     return src1_stride;
   };
@@ -757,11 +1148,9 @@ void CodeGenTileLangPPL::VisitExpr_(const CallNode *op, std::ostream &os) {
     this->PrintIndent();
     this->stream << op_name << "( " << dst << ".addr, " << src0 << ".addr, "
                  << src1 << ".addr, "
-                 << "&" << dst << ".shape, "
-                 << "(" << dst << ".default_stride ? NULL : &" << dst
-                 << ".stride), "
-                 << "(" << src0 << ".default_stride ? NULL : &" << src0
-                 << ".stride), " << src1_stride.str() << dtype << ");\n";
+                 << "&" << dst << ".shape, " << StrideArg(dst) << ", "
+                 << StrideArg(src0) << ", " << src1_stride.str() << dtype
+                 << ");\n";
   };
   // void tpu_bdc_fp_mul_C(local_addr_t dst_addr, local_addr_t src_addr,
   // scalar_t C, const dim4 *shape, const dim4 *dst_stride, const dim4
@@ -784,18 +1173,19 @@ void CodeGenTileLangPPL::VisitExpr_(const CallNode *op, std::ostream &os) {
     this->PrintIndent();
     this->stream << op_name << "( " << dst << ".addr, " << src0 << ".addr, "
                  << "(scalar_t){." << scalar_type << " = " << value << "}, &"
-                 << dst << ".shape, "
-                 << "(" << dst << ".default_stride ? NULL : &" << dst
-                 << ".stride), "
-                 << "(" << dst << ".default_stride ? NULL : &" << dst
-                 << ".stride), " << dtype << ");\n";
+                 << dst << ".shape, " << StrideArg(dst) << ", "
+                 << StrideArg(dst) << ", " << dtype << ");\n";
   };
    std::vector<std::string> inst;
    if (op->op.same_as(builtin::call_extern())) {
     std::string op_name = Downcast<StringImm>(op->args[0])->value;
-    if (op_name == "ppl.copy") {
+      // Declares a __ppl_tensor_info for one side of a data movement op, returns
+      // (name, scope, dtype).
       tl::BufferMap buffer_map;
-      auto process_copy = [&, this](const tl::RegionOp &src)
+      // \p region is the tl.region call \p src was built from, a loop may
+      // carry its global offset in an induction variable.
+      auto process_copy = [&, this](const tl::RegionOp &src,
+                                    const CallNode *region = nullptr)
           -> std::tuple<std::string, std::string, std::string> {
         auto src_buffer = src.GetBuffer();
         auto src_ranges = src.GetRanges();
@@ -808,34 +1198,32 @@ void CodeGenTileLangPPL::VisitExpr_(const CallNode *op, std::ostream &os) {
         std::string new_src_var =
             name_supply_->FreshName(src_buffer->data->name_hint);
         int i = 0;
+        // a runtime extent is printed as the expression
+        auto extent_str = [this](const Range &r) {
+          if (const int64_t *extent = as_const_int(r->extent)) {
+            return std::to_string(*extent);
+          }
+          return this->PrintExpr(r->extent);
+        };
         if (src_ranges.size() == 2) {
-          src_shape =
-              "{1, " +
-              std::to_string(src_ranges[i]->extent.as<IntImmNode>()->value) +
-              ", 1, " +
-              std::to_string(
-                  src_ranges[i + 1]->extent.as<IntImmNode>()->value) +
-              "}";
+          src_shape = "{1, " + extent_str(src_ranges[i]) + ", 1, " +
+                      extent_str(src_ranges[i + 1]) + "}";
         } else if (src_ranges.size() == 4) {
           src_shape = "{";
           for (auto &sr : src_ranges) {
-            src_shape +=
-                std::to_string(sr->extent.as<IntImmNode>()->value) + ", ";
+            src_shape += extent_str(sr) + ", ";
           }
           src_shape[src_shape.size() - 2] = '}';
         }
-        std::string dtype;
-        int bytes_size = 0;
-        if (src_buffer->dtype == DataType::Float(16)) {
-          dtype = "DT_FP16";
-          bytes_size = 2;
-        } else if (src_buffer->dtype == DataType::Float(32)) {
-          dtype = "DT_FP32";
-          bytes_size = 4;
-        } else {
-          LOG(FATAL) << "Unsupported dtype " << src_buffer->dtype;
+        std::string dtype = PPLDataType(src_buffer->dtype);
+        int bytes_size = (src_buffer->dtype.bits() + 7) / 8;
+        // L2 SRAM is addressed like DDR by the DMA engines
+        std::string scope = src_buffer.scope();
+        if (IsL2Scope(scope)) {
+          scope = "global";
         }
-        if (src_buffer.scope() == "global") {
+        if (scope == "global") {
+          SyncSDMA(src_buffer->name);
           std::string src_strides;
 
           auto strides = buffer_stride[src_buffer->name];
@@ -847,14 +1235,21 @@ void CodeGenTileLangPPL::VisitExpr_(const CallNode *op, std::ostream &os) {
           //   min_expr +=
           //       "(" + PrintExpr(e) + ") * " + std::to_string(strides[i]) + "+";
           // }
-          std::vector<int> stride_map = {1, 3};
+          // 2D regions live in the c and w dims of the 4D global tensor
+          std::vector<int> stride_map = src_ranges.size() == 2
+                                            ? std::vector<int>{1, 3}
+                                            : std::vector<int>{0, 1, 2, 3};
           for (int i=0; i < src_ranges.size(); i++){
               auto sr = src_ranges[i];
               min_expr += "("+PrintExpr(sr->min) + ") * " + std::to_string(strides[stride_map[i]]) + "+";
           }
           min_expr[min_expr.size() - 1] = ' ';
           min_expr = "(" + min_expr + ")" + " * " + std::to_string(bytes_size);
-          std::cout << min_expr << std::endl;
+          auto induction = induction_offsets_.find(region);
+          if (induction != induction_offsets_.end()) {
+            min_expr = induction->second;
+          }
+          default_stride_[new_src_var] = false;
           inst.push_back("__ppl_tensor_info " + new_src_var +
                          " = {.shape = " + src_shape +
                          ", .stride = " + src_strides + ", .addr = " + src_id +
@@ -862,7 +1257,14 @@ void CodeGenTileLangPPL::VisitExpr_(const CallNode *op, std::ostream &os) {
                          ", .mode = 2, .size = 1, .offset = " + min_expr +
                          ", .unsigned_flag = 0, .default_stride = false};\n");
         } else if (src_buffer.scope() == "shared.dyn") {
-
+          if ((src_ranges.size() == 2 || src_ranges.size() == 4) &&
+              src.IsFullRegion() &&
+              default_stride_.count(var_idmap_[src_buffer->data.get()])) {
+            // the whole tile is already described by its allocation
+            return std::make_tuple(var_idmap_[src_buffer->data.get()], scope,
+                                   dtype);
+          }
+          default_stride_[new_src_var] = true;
           inst.push_back(
               "__ppl_tensor_info " + new_src_var + " = {.shape = " + src_shape +
               ", .stride = NULL, .addr = " +
@@ -870,28 +1272,146 @@ void CodeGenTileLangPPL::VisitExpr_(const CallNode *op, std::ostream &os) {
               ", .mode = 0, .size = 1, .offset = 0, .unsigned_flag = 0, "
               ".default_stride = true};\n");
         }
-        return std::make_tuple(new_src_var, src_buffer.scope(), dtype);
+        return std::make_tuple(new_src_var, scope, dtype);
       };
+    // Tensor name behind the access_ptr argument \p idx, empty for an optional
+    // operand passed as 0.
+    auto ptr_id = [this, op](int idx) -> std::string {
+      const auto *ptr = op->args[idx].as<CallNode>();
+      return ptr ? var_idmap_[ptr->args[1].as<VarNode>()] : "";
+    };
+    auto ptr_dtype = [op](int idx) {
+      return op->args[idx].as<CallNode>()->args[0].as<CallNode>()->dtype;
+    };
+    auto int_arg = [op](int idx) {
+      return std::to_string(Downcast<IntImm>(op->args[idx])->value);
+    };
+    auto float_arg = [op](int idx) {
+      std::ostringstream os;
+      os << std::setprecision(9) << Downcast<FloatImm>(op->args[idx])->value;
+      return os.str();
+    };
+    // Dequantizes local \p src into \p dst: per tensor with scalar
+    // scale/zero point when \p quant is empty, per channel with the
+    // (scale, zp) pairs of \p quant, or per \p group elements of a row.
+    // \p src_bits 4 reads two int4 values from every byte of src.
+    auto emit_dequant = [this](const std::string &dst, DataType dst_t,
+                               const std::string &src, DataType src_t,
+                               const std::string &quant,
+                               const std::string &scale, double zero_point,
+                               int64_t group, int64_t src_bits) {
+      std::string src_dtype = PPLDataType(src_t);
+      if (src_bits == 4) {
+        ICHECK(src_t.bits() == 8) << "int4 data must be packed into 8-bit bytes";
+        src_dtype = src_t.is_int() ? "DT_INT4" : "DT_UINT4";
+      }
+      this->PrintIndent();
+      if (group > 0) {
+        ICHECK(dst_t.bits() == 16 && !quant.empty())
+            << "group dequant produces fp16/bf16 and needs a quant tile";
+        this->stream << "tpu_bdc_f16_group_dequant(" << dst << ".addr, " << src
+                     << ".addr, " << quant << ".addr, &" << dst << ".shape, "
+                     << src_dtype << ", " << PPLDataType(dst_t) << ", "
+                     << group << ");\n";
+        return;
+      }
+      ICHECK(dst_t == DataType::Float(32))
+          << "per-tensor and per-channel dequant produce fp32, got " << dst_t;
+      if (quant.empty()) {
+        this->stream << "tpu_bdc_fp32_dequant(" << dst << ".addr, " << src
+                     << ".addr, &" << dst << ".shape, "
+                     << PPLScalar(src_t, zero_point) << ", " << scale << ", "
+                     << src_dtype << ", RM_HALF_TO_EVEN);\n";
+      } else {
+        this->stream << "tpu_bdc_fp32_pc_dequant(" << dst << ".addr, " << src
+                     << ".addr, " << quant << ".addr, &" << dst << ".shape, "
+                     << src_dtype << ", RM_HALF_TO_EVEN);\n";
+      }
+    };
+    if (op_name == "ppl.copy") {
       tvm::Dump(op);
       tl::RegionOp src =
           tl::RegionOp(op->args[1].as<CallNode>()->args, buffer_map);
       // tvm::Dump(src);
       tl::RegionOp dst =
           tl::RegionOp(op->args[2].as<CallNode>()->args, buffer_map);
-      auto [src_var_id, src_flag, src_dtype] = process_copy(src);
-      auto [dst_var_id, dst_flag, dst_dtype] = process_copy(dst);
+      auto [src_var_id, src_flag, src_dtype] =
+          process_copy(src, op->args[1].as<CallNode>());
+      auto [dst_var_id, dst_flag, dst_dtype] =
+          process_copy(dst, op->args[2].as<CallNode>());
       std::string ppl_inst;
-      if (src_dtype != dst_dtype) {
+      if (op->args.size() > 3) {
+        // Halo load: the source window of a conv tile may start before or end
+        // after the tensor in h/w. Only the valid part is loaded, the border
+        // is filled with the pad value, so neighbouring tiles can overlap.
+        ICHECK(src_flag == "global" && dst_flag == "shared.dyn" &&
+               src.GetRanges().size() == 4 && src_dtype == dst_dtype)
+            << "ppl.copy with a pad value loads a 4D global window into a "
+               "local tile of the same dtype";
+        for (auto &i : inst) {
+          this->PrintIndent();
+          this->stream << i;
+        }
+        auto ranges = src.GetRanges();
+        auto src_buffer = src.GetBuffer();
+        auto shape = buffer_shape[src_buffer->name];
+        auto strides = buffer_stride[src_buffer->name];
+        int bytes = (src_buffer->dtype.bits() + 7) / 8;
+        double pad = Downcast<FloatImm>(op->args[3])->value;
+        std::string base = var_idmap_.count(src_buffer->data.get())
+                               ? var_idmap_[src_buffer->data.get()]
+                               : this->parameter_map[src_buffer->name];
+        auto line = [this](const std::string &code) {
+          this->PrintIndent();
+          this->stream << code << "\n";
+        };
+        line("{");
+        int scope = this->BeginScope();
+        line("int h0 = " + PrintExpr(ranges[2]->min) + ", w0 = " +
+             PrintExpr(ranges[3]->min) + ";");
+        line("int h_lo = MAX(0, -h0), h_hi = MAX(0, h0 + " +
+             PrintExpr(ranges[2]->extent) + " - " + std::to_string(shape[2]) +
+             ");");
+        line("int w_lo = MAX(0, -w0), w_hi = MAX(0, w0 + " +
+             PrintExpr(ranges[3]->extent) + " - " + std::to_string(shape[3]) +
+             ");");
+        line("dim4 valid_shape = " + dst_var_id + ".shape;");
+        line("valid_shape.h -= h_lo + h_hi;");
+        line("valid_shape.w -= w_lo + w_hi;");
+        line("if (h_lo || h_hi || w_lo || w_hi)");
+        line("  tpu_bdc_set_C(" + dst_var_id + ".addr, " +
+             PPLScalar(src_buffer->dtype, pad) + ", &" + dst_var_id +
+             ".shape, NULL, " + dst_dtype + ");");
+        line("if (valid_shape.h > 0 && valid_shape.w > 0) {");
+        int copy_scope = this->BeginScope();
+        line("dim4 local_stride;");
+        line("tpu_aligned_stride(&local_stride, 0, &" + dst_var_id + ".shape, " +
+             dst_dtype + ");");
+        line("dim4 global_stride = " + vector2string(strides) + ";");
+        line("tpu_gdma_cpy_S2L(" + dst_var_id +
+             ".addr + (h_lo * local_stride.h + w_lo) * " +
+             std::to_string(bytes) + ", " + base + ".addr + ((" +
+             PrintExpr(ranges[0]->min) + ") * " + std::to_string(strides[0]) +
+             " + (" + PrintExpr(ranges[1]->min) + ") * " +
+             std::to_string(strides[1]) + " + (h0 + h_lo) * " +
+             std::to_string(strides[2]) + " + (w0 + w_lo)) * " +
+             std::to_string(bytes) +
+             ", &valid_shape, &local_stride, &global_stride, " + dst_dtype +
+             ");");
+        this->EndScope(copy_scope);
+        line("}");
+        this->EndScope(scope);
+        line("}");
+      } else if (src_dtype != dst_dtype) {
         // void tpu_bdc_cast(local_addr_t dst_addr, local_addr_t src_addr, const
         // dim4 *shape, const dim4 *dst_stride, const dim4 *src_stride,
         // data_type_t dst_dtype, data_type_t src_dtype, rounding_mode_t mode)
         // 使用RM_HALF_TO_EVEN舍入模式，只有在浮点数据类型参与的转换时使用
         ppl_inst += "tpu_bdc_cast(" + dst_var_id + ".addr, " + src_var_id +
-                    ".addr, " + "&" + dst_var_id + ".shape, " + "(" +
-                    dst_var_id + ".default_stride ? NULL : &" + dst_var_id +
-                    ".stride), " + "(" + src_var_id +
-                    ".default_stride ? NULL : &" + src_var_id + ".stride), " +
-                    dst_dtype + ", " + src_dtype + ", " + "RM_HALF_TO_EVEN" +
+                    ".addr, " + "&" + dst_var_id + ".shape, " +
+                    StrideArg(dst_var_id) + ", " + StrideArg(src_var_id) +
+                    ", " + dst_dtype + ", " + src_dtype + ", " +
+                    "RM_HALF_TO_EVEN" +
                     ");\n";
         inst.push_back(ppl_inst);
         for (auto &i : inst) {
@@ -903,44 +1423,541 @@ void CodeGenTileLangPPL::VisitExpr_(const CallNode *op, std::ostream &os) {
         ppl_inst += "tpu_gdma_cpy_S2L";
       } else if (src_flag == "shared.dyn" && dst_flag == "global") {
         ppl_inst += "tpu_gdma_cpy_L2S";
+      } else if (src_flag == "global" && dst_flag == "global") {
+        // DDR/L2 -> DDR/L2 runs on the otherwise idle SDMA engine, next to the
+        // GDMA tile loads and BDC compute; later users wait in SyncSDMA
+        auto contiguous = [](const tl::RegionOp &r) {
+          auto ranges = r.GetRanges();
+          auto shape = r.GetBuffer()->shape;
+          size_t i = 0;
+          while (i < ranges.size() && is_one(ranges[i]->extent)) {
+            ++i;
+          }
+          for (size_t j = i + 1; j < ranges.size(); ++j) {
+            if (!arith::Analyzer().CanProveEqual(ranges[j]->extent,
+                                                 shape[j])) {
+              return false;
+            }
+          }
+          return true;
+        };
+        for (auto &i : inst) {
+          this->PrintIndent();
+          this->stream << i;
+        }
+        SyncGDMA(src.GetBuffer()->name);
+        SyncGDMA(dst.GetBuffer()->name);
+        this->PrintIndent();
+        // the element count of a plain memcpy must be known here, a slice
+        // with a runtime extent (e.g. a KV cache append) uses the strided copy
+        int64_t count = 1;
+        for (const Range &r : dst.GetRanges()) {
+          const int64_t *extent = as_const_int(r->extent);
+          count = extent ? count * *extent : -1;
+          if (count < 0) {
+            break;
+          }
+        }
+        if (count >= 0 && contiguous(src) && contiguous(dst)) {
+          this->stream << "tpu_sdma_system_cpy(" << dst_var_id << ".addr, "
+                       << src_var_id << ".addr, " << count << ", "
+                       << src_dtype << ");\n";
+        } else {
+          this->stream << "tpu_sdma_cpy_S2S(" << dst_var_id << ".addr, "
+                       << src_var_id << ".addr, &" << dst_var_id
+                       << ".shape, &" << dst_var_id << ".stride, &"
+                       << src_var_id << ".stride, " << src_dtype << ");\n";
+        }
+        sdma_pending_.insert(src.GetBuffer()->name);
+        sdma_pending_.insert(dst.GetBuffer()->name);
+        return;
       } else { 
           // local mem -> local mem copy within the same NPU
           ppl_inst += "tpu_bdc_cpy";
       }
   
         ppl_inst += "(" + dst_var_id + ".addr, " + src_var_id + ".addr, &" +
-                    dst_var_id + ".shape, " + "(" + dst_var_id +
-                    ".default_stride ? NULL : &" + dst_var_id + ".stride), " +
-                    "(" + src_var_id + ".default_stride ? NULL : &" +
-                    src_var_id + ".stride), " + src_dtype + ");\n";
+                    dst_var_id + ".shape, " + StrideArg(dst_var_id) + ", " +
+                    StrideArg(src_var_id) + ", " + src_dtype + ");\n";
       inst.push_back(ppl_inst);
+      if (dst_flag == "global") {
+        gdma_pending_.insert(dst.GetBuffer()->name);
+      }
         for (auto &i : inst) {
         this->PrintIndent();
         this->stream << i;
       }
       }
+    } else if (op_name == "ppl.transpose") {
+      // Swaps the c and w dims of a tile (a 2D [M, N] tile is {1, M, 1, N}).
+      // Transposes that touch global memory ride on the GDMA copy itself.
+      tl::RegionOp src =
+          tl::RegionOp(op->args[1].as<CallNode>()->args, buffer_map);
+      tl::RegionOp dst =
+          tl::RegionOp(op->args[2].as<CallNode>()->args, buffer_map);
+      auto [src_var_id, src_flag, src_dtype] =
+          process_copy(src, op->args[1].as<CallNode>());
+      auto [dst_var_id, dst_flag, dst_dtype] =
+          process_copy(dst, op->args[2].as<CallNode>());
+      ICHECK(src_dtype == dst_dtype)
+          << "ppl.transpose does not convert dtypes, got " << src_dtype
+          << " and " << dst_dtype;
+      for (auto &i : inst) {
+        this->PrintIndent();
+        this->stream << i;
+      }
+      std::string strides = StrideArg(dst_var_id) + ", " +
+                            StrideArg(src_var_id) + ", " + src_dtype + ");\n";
+      auto gdma_trans = [&](const std::string &dir) {
+        return "tpu_gdma_cpy_cw_trans_" + dir + "(" + dst_var_id + ".addr, " +
+               src_var_id + ".addr, &" + dst_var_id + ".shape, " + strides;
+      };
+      this->PrintIndent();
+      if (src_flag == "global" && dst_flag == "shared.dyn") {
+        this->stream << gdma_trans("S2L");
+      } else if (src_flag == "shared.dyn" && dst_flag == "global") {
+        this->stream << gdma_trans("L2S");
+        gdma_pending_.insert(dst.GetBuffer()->name);
+      } else if (src_flag == "global" && dst_flag == "global") {
+        this->stream << gdma_trans("S2S");
+        gdma_pending_.insert(dst.GetBuffer()->name);
+      } else {
+        // the BDC transpose only handles dense tiles whose c and w both fit
+        // in one round of NPUs, anything else goes through the GDMA
+        auto dst_dense = default_stride_.find(dst_var_id);
+        auto src_dense = default_stride_.find(src_var_id);
+        bool known = dst_dense != default_stride_.end() &&
+                     src_dense != default_stride_.end();
+        if (known && !(dst_dense->second && src_dense->second)) {
+          this->stream << gdma_trans("L2L");
+          return;
+        }
+        std::string dense = known ? "" : dst_var_id + ".default_stride && " +
+                                             src_var_id + ".default_stride && ";
+        this->stream << "if (" << dense << dst_var_id
+                     << ".shape.c <= NPU_NUM && " << dst_var_id
+                     << ".shape.w <= NPU_NUM) {\n";
+        int then_scope = this->BeginScope();
+        this->PrintIndent();
+        this->stream << "tpu_bdc_cw_trans(" << dst_var_id << ".addr, "
+                     << src_var_id << ".addr, &" << dst_var_id << ".shape, "
+                     << src_dtype << ");\n";
+        this->EndScope(then_scope);
+        this->PrintIndent();
+        this->stream << "} else {\n";
+        int else_scope = this->BeginScope();
+        this->PrintIndent();
+        this->stream << gdma_trans("L2L");
+        this->EndScope(else_scope);
+        this->PrintIndent();
+        this->stream << "}\n";
+      }
+    } else if (op_name == "ppl.conv2d") {
+      // T.call_extern("handle", "ppl.conv2d", out, in, weight, bias, requant,
+      //               acc, kh, kw, stride_h, stride_w, pad_t, pad_b, pad_l,
+      //               pad_r, dilation_h, dilation_w, depthwise, rshift)
+      // bias/requant/acc are 0 when absent.
+      std::string out = ptr_id(1), in = ptr_id(2), weight = ptr_id(3);
+      std::string bias = ptr_id(4), requant = ptr_id(5), acc = ptr_id(6);
+      DataType in_t = ptr_dtype(2), out_t = ptr_dtype(1), w_t = ptr_dtype(3);
+      bool depthwise = Downcast<IntImm>(op->args[17])->value != 0;
+      bool has_bias = !bias.empty();
+      std::string bias_addr = has_bias ? bias + ".addr" : "0";
+      int output_c = buffer_shape[out][1];
+
+      this->PrintIndent();
+      this->stream << "{\n";
+      int scope = this->BeginScope();
+      this->PrintIndent();
+      this->stream << "dim2 kernel = {" << int_arg(7) << ", " << int_arg(8)
+                   << "}, stride = {" << int_arg(9) << ", " << int_arg(10)
+                   << "}, dilation = {" << int_arg(15) << ", " << int_arg(16)
+                   << "};\n";
+      this->PrintIndent();
+      this->stream << "padding_t padding = {" << int_arg(11) << ", "
+                   << int_arg(12) << ", " << int_arg(13) << ", "
+                   << int_arg(14) << "};\n";
+      this->PrintIndent();
+      if (in_t.is_float() || in_t.is_bfloat16()) {
+        if (depthwise) {
+          this->stream << "tpu_bdc_fp_depthwise2d(" << out << ".addr, " << in
+                       << ".addr, " << weight << ".addr, " << bias_addr
+                       << ", &" << in << ".shape, &kernel, &padding, &stride, "
+                       << "&dilation, " << PPLDataType(in_t) << ", "
+                       << (has_bias ? "true" : "false") << ");\n";
+        } else {
+          this->stream << "tpu_bdc_fp_conv2d(" << out << ".addr, " << in
+                       << ".addr, " << weight << ".addr, " << bias_addr
+                       << ", &" << in << ".shape, NULL, " << output_c
+                       << ", &kernel, &padding, &stride, &dilation, "
+                       << PPLDataType(out_t) << ", " << PPLDataType(in_t)
+                       << ", " << (has_bias ? "true" : "false")
+                       << ", false);\n";
+        }
+      } else {
+        // int8: with per-channel requant the conv accumulates into the int32
+        // acc tile which is then requantized into out
+        std::string dst = requant.empty() ? out : acc;
+        std::string dst_dtype =
+            requant.empty() ? PPLDataType(out_t) : std::string("DT_INT32");
+        std::string bias_dtype =
+            has_bias ? PPLDataType(ptr_dtype(4)) : std::string("DT_INT32");
+        if (depthwise) {
+          this->stream << "tpu_bdc_int8_depthwise2d(" << dst << ".addr, "
+                       << in << ".addr, " << weight << ".addr, " << bias_addr
+                       << ", " << PPLScalar(in_t, 0) << ", &" << in
+                       << ".shape, &kernel, &padding, &stride, &dilation, "
+                       << dst_dtype << ", " << PPLDataType(in_t) << ", "
+                       << PPLDataType(w_t) << ", " << bias_dtype << ", "
+                       << int_arg(18) << ", " << (has_bias ? "true" : "false")
+                       << ", false, RM_HALF_AWAY_FROM_ZERO);\n";
+        } else {
+          this->stream << "tpu_bdc_int8_sym_quant_conv2d(" << dst << ".addr, "
+                       << in << ".addr, " << weight << ".addr, " << bias_addr
+                       << ", &" << in << ".shape, NULL, " << output_c
+                       << ", &kernel, &padding, &stride, &dilation, "
+                       << dst_dtype << ", " << PPLDataType(in_t) << ", "
+                       << PPLDataType(w_t) << ", " << bias_dtype << ", "
+                       << int_arg(18) << ", " << (has_bias ? "true" : "false")
+                       << ", false);\n";
+        }
+        if (!requant.empty()) {
+          this->PrintIndent();
+          this->stream << "tpu_bdc_int_pc_requant(" << out << ".addr, " << acc
+                       << ".addr, " << requant << ".addr, &" << out
+                       << ".shape, " << PPLDataType(out_t)
+                       << ", DT_INT32, RM_HALF_AWAY_FROM_ZERO);\n";
+        }
+      }
+      this->EndScope(scope);
+      this->PrintIndent();
+      this->stream << "}\n";
+    } else if (op_name == "ppl.quantize") {
+      // T.call_extern("handle", "ppl.quantize", out, in, quant, scale, zp)
+      // quant is 0 for per-tensor quantization with scalar scale/zp.
+      std::string out = ptr_id(1), in = ptr_id(2), quant = ptr_id(3);
+      std::string out_dtype = PPLDataType(ptr_dtype(1));
+      std::string in_dtype = PPLDataType(ptr_dtype(2));
+      this->PrintIndent();
+      if (quant.empty()) {
+        this->stream << "tpu_bdc_fp32_requant(" << out << ".addr, " << in
+                     << ".addr, &" << out << ".shape, " << float_arg(4) << ", "
+                     << float_arg(5) << ", " << out_dtype << ", " << in_dtype
+                     << ", RM_HALF_TO_EVEN, RM_HALF_TO_EVEN);\n";
+      } else {
+        this->stream << "tpu_bdc_fp32_pc_requant(" << out << ".addr, " << in
+                     << ".addr, " << quant << ".addr, &" << out << ".shape, "
+                     << out_dtype << ", " << in_dtype
+                     << ", RM_HALF_TO_EVEN, RM_HALF_TO_EVEN);\n";
+      }
+    } else if (op_name == "ppl.dequantize") {
+      // T.call_extern("handle", "ppl.dequantize", out, in, quant, scale, zp,
+      //               group, src_bits)
+      emit_dequant(ptr_id(1), ptr_dtype(1), ptr_id(2), ptr_dtype(2), ptr_id(3),
+                   float_arg(4), Downcast<FloatImm>(op->args[5])->value,
+                   Downcast<IntImm>(op->args[6])->value,
+                   Downcast<IntImm>(op->args[7])->value);
+    } else if (op_name == "ppl.grouped_gemm") {
+      // T.call_extern("handle", "ppl.grouped_gemm", A, B, C, offsets, A_0, A_1,
+      //               B_0, B_1, C_0, C_1, num_experts, N, K, block_M,
+      //               block_N, block_K)
+      // A [total_M, K] rows of expert e are offsets[e] .. offsets[e + 1],
+      // B [num_experts, K, N], C [total_M, N]. The (expert, tile) pairs are
+      // spread over the cores; on each core the loads of step s+1 overlap the
+      // mm of step s and the store of the previous tile, also across experts.
+      auto global_id = [this, op](int idx) {
+        const VarNode *var = op->args[idx].as<CallNode>()->args[1].as<VarNode>();
+        auto it = var_idmap_.find(var);
+        return it != var_idmap_.end() ? it->second
+                                      : this->parameter_map[var->name_hint];
+      };
+      std::string a = global_id(1), b = global_id(2), c = global_id(3);
+      std::string offsets = global_id(4);
+      std::string a_buf[2] = {ptr_id(5), ptr_id(6)};
+      std::string b_buf[2] = {ptr_id(7), ptr_id(8)};
+      std::string c_buf[2] = {ptr_id(9), ptr_id(10)};
+      DataType in_t = ptr_dtype(1);
+      ICHECK(ptr_dtype(3) == DataType::Float(32))
+          << "ppl.grouped_gemm accumulates and stores float32";
+      std::string in_dtype = PPLDataType(in_t);
+      int in_bytes = (in_t.bits() + 7) / 8;
+      std::string E = int_arg(11), N = int_arg(12), K = int_arg(13);
+      std::string BM = int_arg(14), BN = int_arg(15), BK = int_arg(16);
+      int64_t k_tiles = (Downcast<IntImm>(op->args[13])->value +
+                         Downcast<IntImm>(op->args[16])->value - 1) /
+                        Downcast<IntImm>(op->args[16])->value;
+      std::string KT = std::to_string(k_tiles);
+      grouped_gemm_ = true;
+      SyncSDMA();
+      gdma_pending_.insert(
+          op->args[3].as<CallNode>()->args[1].as<VarNode>()->name_hint);
+      auto pick = [](const std::string buf[2], const std::string &parity) {
+        return "((" + parity + ") & 1 ? " + buf[1] + ".addr : " + buf[0] +
+               ".addr)";
+      };
+      auto line = [this](const std::string &text) {
+        this->PrintIndent();
+        this->stream << text << "\n";
+      };
+      auto store = [&](const std::string &st, const std::string &parity) {
+        line("{");
+        int sid = this->BeginScope();
+        line("dim4 shape = {1, " + st + ".rows, 1, " + st + ".cols};");
+        line("dim4 stride = {" + N + ", " + N + ", " + N + ", 1};");
+        line("tpu_gdma_cpy_L2S(" + c + ".addr + ((u64)" + st + ".m0 * " + N +
+             " + " + st + ".n0) * 4, " + pick(c_buf, parity) +
+             ", &shape, &stride, NULL, DT_FP32);");
+        this->EndScope(sid);
+        line("}");
+      };
+
+      line("{");
+      int scope = this->BeginScope();
+      line("int core_idx = tpu_core_index();");
+      line("int core_num = tpu_core_num();");
+      line("tpu_invalidate_cache(" + offsets + ".addr, (" + E +
+           " + 1) * sizeof(int));");
+      line("const int *offsets = (const int *)tpu_global_mem_addr(" + offsets +
+           ".addr);");
+      line("int tiles = __ppl_grouped_tile_num(offsets, " + E + ", " + BM +
+           ", (" + N + " + " + BN + " - 1) / " + BN + ");");
+      line("int steps = (tiles > core_idx ? (tiles - core_idx + core_num - 1) "
+           "/ core_num : 0) * " + KT + ";");
+      line("__ppl_grouped_step cur, prev, done;");
+      line("for (int s = 0; s <= steps; ++s) {");
+      int loop = this->BeginScope();
+      line("tpu_parallel_start();");
+      line("if (s < steps) {");
+      int load = this->BeginScope();
+      line("__ppl_grouped_step_at(offsets, " + E + ", " + BM + ", " + BN +
+           ", " + BK + ", " + N + ", " + K + ", core_idx + s / " + KT +
+           " * core_num, s % " + KT + ", &cur);");
+      line("dim4 a_shape = {1, cur.rows, 1, cur.ks};");
+      line("dim4 a_stride = {" + K + ", " + K + ", " + K + ", 1};");
+      line("dim4 b_shape = {1, cur.ks, 1, cur.cols};");
+      line("dim4 b_stride = {" + N + ", " + N + ", " + N + ", 1};");
+      line("tpu_gdma_cpy_S2L(" + pick(a_buf, "s") + ", " + a +
+           ".addr + ((u64)cur.m0 * " + K + " + cur.k0) * " +
+           std::to_string(in_bytes) + ", &a_shape, NULL, &a_stride, " +
+           in_dtype + ");");
+      line("tpu_gdma_cpy_S2L(" + pick(b_buf, "s") + ", " + b +
+           ".addr + (((u64)cur.expert * " + K + " + cur.k0) * " + N +
+           " + cur.n0) * " + std::to_string(in_bytes) +
+           ", &b_shape, NULL, &b_stride, " + in_dtype + ");");
+      this->EndScope(load);
+      line("}");
+      line("if (s > 0) {");
+      int mm = this->BeginScope();
+      line("tpu_bdc_fp_mm(" + pick(c_buf, "(s - 1) / " + KT) + ", " +
+           pick(a_buf, "s - 1") + ", " + pick(b_buf, "s - 1") +
+           ", prev.rows, prev.ks, prev.cols, DT_FP32, " + in_dtype +
+           ", prev.k != 0);");
+      this->EndScope(mm);
+      line("}");
+      line("if (s > 1 && done.k == " + std::to_string(k_tiles - 1) + ") {");
+      int st = this->BeginScope();
+      store("done", "(s - 2) / " + KT);
+      this->EndScope(st);
+      line("}");
+      line("tpu_parallel_end();");
+      line("done = prev;");
+      line("prev = cur;");
+      this->EndScope(loop);
+      line("}");
+      line("if (steps > 0) {");
+      int tail = this->BeginScope();
+      store("done", "(steps - 1) / " + KT);
+      this->EndScope(tail);
+      line("}");
+      this->EndScope(scope);
+      line("}");
+    } else if (op_name == "ppl.stage_l2") {
+      // T.call_extern("handle", "ppl.stage_l2", src_region, dst_region)
+      // Every core copies its share of the channels into L2, then all cores
+      // meet so the staged tensor is complete before anyone reads it.
+      tl::RegionOp src =
+          tl::RegionOp(op->args[1].as<CallNode>()->args, buffer_map);
+      tl::RegionOp dst =
+          tl::RegionOp(op->args[2].as<CallNode>()->args, buffer_map);
+      ICHECK(IsL2Scope(dst.GetBuffer().scope()))
+          << "ppl.stage_l2 writes a shared.l2/global.l2 buffer";
+      auto [src_var_id, src_flag, src_dtype] =
+          process_copy(src, op->args[1].as<CallNode>());
+      auto [dst_var_id, dst_flag, dst_dtype] =
+          process_copy(dst, op->args[2].as<CallNode>());
+      ICHECK(src_flag == "global" && src_dtype == dst_dtype)
+          << "ppl.stage_l2 copies a global tensor of the same dtype";
+      std::string bytes =
+          std::to_string((src.GetBuffer()->dtype.bits() + 7) / 8);
+      for (auto &i : inst) {
+        this->PrintIndent();
+        this->stream << i;
+      }
+      auto line = [this](const std::string &code) {
+        this->PrintIndent();
+        this->stream << code << "\n";
+      };
+      line("{");
+      int scope = this->BeginScope();
+      line("int core_idx = tpu_core_index();");
+      line("int core_num = tpu_core_num();");
+      line("int slice = (" + dst_var_id + ".shape.c + core_num - 1) / core_num;");
+      line("int c0 = core_idx * slice;");
+      line("if (c0 < " + dst_var_id + ".shape.c) {");
+      int copy_scope = this->BeginScope();
+      line("dim4 part = " + dst_var_id + ".shape;");
+      line("part.c = MIN(slice, part.c - c0);");
+      line("tpu_gdma_cpy_S2S(" + dst_var_id + ".addr + (u64)c0 * " +
+           dst_var_id + ".stride.c * " + bytes + ", " + src_var_id +
+           ".addr + (u64)c0 * " + src_var_id + ".stride.c * " + bytes +
+           ", &part, &" + dst_var_id + ".stride, &" + src_var_id +
+           ".stride, " + src_dtype + ");");
+      this->EndScope(copy_scope);
+      line("}");
+      line("tpu_sync_all();");
+      line("tpu_sync_core();");
+      gdma_pending_.clear();
+      this->EndScope(scope);
+      line("}");
+    } else if (op_name == "ppl.all_reduce" || op_name == "ppl.all_gather" ||
+               op_name == "ppl.reduce_scatter") {
+      // T.call_extern("handle", "ppl.all_reduce", buf, opcode)
+      // T.call_extern("handle", "ppl.all_gather", src, dst)
+      // T.call_extern("handle", "ppl.reduce_scatter", src, dst, opcode)
+      // Operands are global (or L2) 2D regions. all_gather/reduce_scatter
+      // run in place on the full tensor (dst resp. src) and move the rank's
+      // chunk with one copy. The collective is lowered where it is written,
+      // on its own regions: TIR loops and branches take the same path on
+      // every core, only the regions emitted here depend on the core index,
+      // so every core reaches both barriers.
+      tl::RegionOp first =
+          tl::RegionOp(op->args[1].as<CallNode>()->args, buffer_map);
+      auto [a_var_id, a_flag, a_dtype] = process_copy(first);
+      std::string b_var_id, b_flag, b_dtype;
+      if (op_name != "ppl.all_reduce") {
+        tl::RegionOp second =
+            tl::RegionOp(op->args[2].as<CallNode>()->args, buffer_map);
+        std::tie(b_var_id, b_flag, b_dtype) = process_copy(second);
+        ICHECK(b_flag == "global" && a_dtype == b_dtype)
+            << op_name << " needs global operands of the same dtype";
+      }
+      ICHECK(a_flag == "global") << op_name << " needs global operands";
+      collective_ = true;
+      for (auto &i : inst) {
+        this->PrintIndent();
+        this->stream << i;
+      }
+      auto line = [this](const std::string &code) {
+        this->PrintIndent();
+        this->stream << code << "\n";
+      };
+      // addr/rows/w/row stride of this core's column slice of a descriptor
+      auto view = [](const std::string &t) {
+        return t + ".addr + col_offset, " + t + ".shape.c, cols, " + t +
+               ".stride.c";
+      };
+      // copies rank's chunk of `full` to/from `part`
+      auto chunk_copy = [&](const std::string &dst, const std::string &src,
+                            const std::string &full, bool to_part) {
+        line("int b, n;");
+        line("__ppl_cdma_chunk(tpu_rank(), tpu_chip_num(), " + full +
+             ".shape.c, &b, &n);");
+        line("if (n > 0) {");
+        int copy_scope = this->BeginScope();
+        line("dim4 shape = {1, n, 1, cols};");
+        std::string offset = "(u64)b * " + full + ".stride.c * " +
+                             "tpu_data_type_size(" + a_dtype + ")";
+        line("tpu_gdma_cpy_S2S(" + dst + ".addr + col_offset" +
+             (to_part ? std::string("") : " + " + offset) + ", " + src +
+             ".addr + col_offset" +
+             (to_part ? " + " + offset : std::string("")) +
+             ", &shape, &" + dst + ".stride, &" + src + ".stride, " + a_dtype +
+             ");");
+        line("tpu_sync_all_gdma();");
+        this->EndScope(copy_scope);
+        line("}");
+      };
+      line("{");
+      int scope = this->BeginScope();
+      // the operands were written by GDMA stores of every core
+      line("tpu_sync_all_gdma();");
+      line("tpu_sync_core();");
+      gdma_pending_.clear();
+      // the cores split the columns and each runs the ring on its slice, the
+      // rings of one core index on every chip pair up
+      std::string full = op_name == "ppl.all_gather" ? b_var_id : a_var_id;
+      line("int core_cols = (" + full +
+           ".shape.w + tpu_core_num() - 1) / tpu_core_num();");
+      line("int col0 = MIN(tpu_core_index() * core_cols, " + full +
+           ".shape.w);");
+      line("int cols = MIN(core_cols, " + full + ".shape.w - col0);");
+      line("u64 col_offset = (u64)col0 * tpu_data_type_size(" + a_dtype +
+           ");");
+      line("if (cols > 0) {");
+      int core_scope = this->BeginScope();
+      if (op_name == "ppl.all_reduce") {
+        std::string opcode = int_arg(2);
+        line("#if defined(__sg2260__) && defined(USING_CMODEL)");
+        line("tpu_cdma_fake_all_reduce(tpu_chip_id(), " + a_var_id +
+             ".addr + col_offset, 1, " + a_var_id + ".shape.c, 1, cols, " +
+             a_var_id + ".shape.c * " + a_var_id + ".stride.c, " + a_var_id +
+             ".stride.c, " + a_var_id + ".stride.c, " + opcode + ", " +
+             a_dtype + ");");
+        line("tpu_cdma_poll();");
+        line("#else");
+        line("__ppl_reduce_scatter(" + view(a_var_id) + ", " + opcode + ", " +
+             a_dtype + ");");
+        line("__ppl_all_gather(" + view(a_var_id) + ", " + a_dtype + ");");
+        line("#endif");
+      } else if (op_name == "ppl.all_gather") {
+        // src is this rank's chunk of dst
+        chunk_copy(b_var_id, a_var_id, b_var_id, false);
+        line("__ppl_all_gather(" + view(b_var_id) + ", " + a_dtype + ");");
+      } else {
+        line("__ppl_reduce_scatter(" + view(a_var_id) + ", " + int_arg(3) +
+             ", " + a_dtype + ");");
+        chunk_copy(b_var_id, a_var_id, a_var_id, true);
+      }
+      this->EndScope(core_scope);
+      line("}");
+      line("tpu_sync_core();");
+      this->EndScope(scope);
+      line("}");
     } else if (op_name == "ppl.fill") {
       auto var_ = op->args[1].as<CallNode>()->args[1].as<VarNode>();
-      auto data_ = var_idmap_[var_];
       auto dtype = op->args[1].as<CallNode>()->args[0].as<CallNode>()->dtype;
-      std::string dtype_1, dtype_2;
-      if (dtype == DataType::Float(16)) {
-        dtype_1 = "f16";
-        dtype_2 = "DT_FP16";
-      } else if (dtype == DataType::Float(32)) {
-        dtype_1 = "f32";
-        dtype_2 = "DT_FP32";
+      // T.ppl_fill(int_buf, 0) passes an integer
+      double value = 0;
+      if (const auto *f = op->args[2].as<FloatImmNode>()) {
+        value = f->value;
+      } else {
+        value = static_cast<double>(Downcast<IntImm>(op->args[2])->value);
       }
-      auto addr = buffer_addrs_[var_];
-      int value = Downcast<FloatImm>(op->args[2])->value;
-      this->PrintIndent();
-      this->stream << "scalar_t " << data_ << "_scalar_" << dtype_1 << " = {."
-                   << dtype_1 << " = " << value << "};\n";
+      const auto *ptr_type = var_->type_annotation.as<PointerTypeNode>();
+      std::string scope = ptr_type ? ptr_type->storage_scope : "";
+      if (scope == "global" || IsL2Scope(scope)) {
+        // zeroing an output or a KV cache is a plain memset for the SDMA
+        std::string name = var_->name_hint;
+        std::string tensor = var_idmap_.count(var_) ? var_idmap_[var_]
+                                                    : parameter_map[name];
+        int64_t count = 1;
+        for (int dim : buffer_shape[name]) {
+          count *= dim;
+        }
+        SyncSDMA(name);
+        SyncGDMA(name);
+        this->PrintIndent();
+        this->stream << "tpu_sdma_system_set(" << tensor << ".addr, "
+                     << PPLScalar(dtype, value) << ", " << count << ", "
+                     << PPLDataType(dtype) << ");\n";
+        sdma_pending_.insert(name);
+        return;
+      }
+      auto data_ = var_idmap_[var_];
       this->PrintIndent();
-      this->stream << "tpu_bdc_set_C(" << data_ << ".addr, " << data_
-                   << "_scalar_" << dtype_1 << ", &" << data_ << ".shape, ("
-                   << data_ << ".default_stride ? NULL : &" << data_
-                   << ".stride), " << dtype_2 << ");\n";
+      this->stream << "tpu_bdc_set_C(" << data_ << ".addr, "
+                   << PPLScalar(dtype, value) << ", &" << data_ << ".shape, "
+                   << StrideArg(data_) << ", " << PPLDataType(dtype) << ");\n";
     } else if (op_name == "ppl.gemm") {
       auto a_access_data =
           var_idmap_[op->args[1].as<CallNode>()->args[1].as<VarNode>()];
@@ -953,6 +1970,15 @@ void CodeGenTileLangPPL::VisitExpr_(const CallNode *op, std::ostream &os) {
       auto N = Downcast<IntImm>(op->args[7])->value;
       auto K = Downcast<IntImm>(op->args[8])->value;
       auto trans_B = Downcast<Bool>(op->args[5])->value;
+      if (op->args.size() > 9) {
+        // weight-only quantized B: (quant, scratch, group, bits) follow K, B is
+        // group dequantized into the fp16 scratch tile right before the mm
+        std::string scratch = ptr_id(10);
+        emit_dequant(scratch, ptr_dtype(10), b_access_data, ptr_dtype(2),
+                     ptr_id(9), "", 0, Downcast<IntImm>(op->args[11])->value,
+                     Downcast<IntImm>(op->args[12])->value);
+        b_access_data = scratch;
+      }
       std::string M_K_N = std::to_string(M) + ", " + std::to_string(K) + ", " +
                           std::to_string(N);
       this->PrintIndent();
@@ -1372,6 +2398,7 @@ void CodeGenTileLangPPL::VisitExpr_(const CallNode *op, std::ostream &os) {
       auto select_num = Downcast<IntImm>(op->args[8])->value;
       auto index_num = Downcast<IntImm>(op->args[9])->value;
       auto const_val = Downcast<FloatImm>(op->args[10])->value;
+      SyncSDMA();
 
       bool input_data_from_local = true;
       bool output_data_to_local = true;
@@ -1541,6 +2568,7 @@ void CodeGenTileLangPPL::VisitExpr_(const CallNode *op, std::ostream &os) {
         // L2S 或S2S
         if (input_data_from_local){
           // L2S
+          gdma_pending_.insert(op->args[1].as<CallNode>()->args[1].as<VarNode>()->name_hint);
           this->stream << "tpu_gdma_cpy_cw_trans_L2S(" << output_tensor << ".addr, " << output_tmp_tensor << ".addr, &ori_output_shape, &ori_output_stride, &output_stride, " << dtype << ");\n";
         } else{
           // S2S todo
@@ -1643,6 +2671,43 @@ void CodeGenTileLangPPL::VisitStmt_(const LetStmtNode *op) {
   PrintStmt(op->body);
 }
  
+void CodeGenTileLangPPL::VisitStmt_(const EvaluateNode *op) {
+  const CallNode *call = op->value.as<CallNode>();
+  if (!profile_ || call == nullptr ||
+      !call->op.same_as(builtin::call_extern()) ||
+      !call->args[0].as<StringImmNode>() ||
+      Downcast<StringImm>(call->args[0])->value.find("ppl.") != 0) {
+    CodeGenC::VisitStmt_(op);
+    return;
+  }
+  // keep the TIR text of the call so the decoder can map records back to the
+  // tilelang statement, escaped for a C string literal
+  std::ostringstream text;
+  text << GetRef<Call>(call);
+  std::string stmt;
+  for (char c : text.str()) {
+    if (c == '"' || c == '\\') {
+      stmt += '\\';
+      stmt += c;
+    } else if (c == '\n') {
+      stmt += ' ';
+    } else {
+      stmt += c;
+    }
+    if (stmt.size() > 240) {
+      stmt += "...";
+      break;
+    }
+  }
+  int stmt_id = profile_stmts_.size();
+  profile_stmts_.push_back(stmt);
+  this->PrintIndent();
+  this->stream << "__ppl_prof_begin(" << stmt_id << ");\n";
+  CodeGenC::VisitStmt_(op);
+  this->PrintIndent();
+  this->stream << "__ppl_prof_end(" << stmt_id << ");\n";
+}
+
 void CodeGenTileLangPPL::VisitStmt_(const AttrStmtNode *op) {
    if (op->attr_key == "tpu_parallel_start") {
      this->PrintIndent();
@@ -1655,6 +2720,32 @@ void CodeGenTileLangPPL::VisitStmt_(const AttrStmtNode *op) {
    this->PrintStmt(op->body);
  }
  
+void CodeGenTileLangPPL::SyncSDMA(const std::string &name) {
+  if (sdma_pending_.empty() || (!name.empty() && !sdma_pending_.count(name))) {
+    return;
+  }
+  this->PrintIndent();
+  this->stream << "tpu_sync_all_sdma();\n";
+  sdma_pending_.clear();
+}
+
+void CodeGenTileLangPPL::SyncGDMA(const std::string &name) {
+  if (gdma_pending_.empty() || (!name.empty() && !gdma_pending_.count(name))) {
+    return;
+  }
+  this->PrintIndent();
+  this->stream << "tpu_sync_all_gdma();\n";
+  gdma_pending_.clear();
+}
+
+std::string CodeGenTileLangPPL::StrideArg(const std::string &tensor) const {
+  auto it = default_stride_.find(tensor);
+  if (it == default_stride_.end()) {
+    return "(" + tensor + ".default_stride ? NULL : &" + tensor + ".stride)";
+  }
+  return it->second ? "NULL" : "&" + tensor + ".stride";
+}
+
 std::string CodeGenTileLangPPL::AllocLocalVarID(const tir::VarNode *v) {
   // ICHECK(!local_buffer_name_map.count(v)) << "Need input to be in SSA form
   // dup " << v->name_hint;
@@ -1670,6 +2761,73 @@ std::string CodeGenTileLangPPL::AllocLocalVarID(const tir::VarNode *v) {
  
 void CodeGenTileLangPPL::VisitStmt_(const AllocateNode *op) {
    ICHECK(!is_zero(op->condition));
+  const auto *ptr_type = op->buffer_var->type_annotation.as<PointerTypeNode>();
+  if (ptr_type && IsL2Scope(ptr_type->storage_scope)) {
+    // AddressAssign places L2 buffers at a fixed offset of the L2 SRAM, every
+    // core sees the same tensor
+    ICHECK(op->extents.size() == 2 || op->extents.size() == 4)
+        << "L2 buffers must be 2D or 4D";
+    std::vector<int> shapes;
+    for (const PrimExpr &e : op->extents) {
+      shapes.push_back(e.as<IntImmNode>()->value);
+    }
+    if (shapes.size() == 2) {
+      // a 2D [M, N] tensor is {1, M, 1, N} like a global parameter, so the
+      // DMA offsets step rows by stride.c
+      shapes = {1, shapes[0], 1, shapes[1]};
+    }
+    std::string name = op->buffer_var->name_hint;
+    buffer_shape[name] = shapes;
+    buffer_stride[name] = {1, 1, 1, 1};
+    for (int i = 2; i >= 0; i--) {
+      buffer_stride[name][i] = shapes[i + 1] * buffer_stride[name][i + 1];
+    }
+    std::string vid = AllocVarID(op->buffer_var.get());
+    auto addr = f_attrs.GetAttr(vid, PrimExpr(0)).as<IntImmNode>()->value;
+    int64_t tensor_size = (op->dtype.bits() + 7) / 8;
+    for (int dim : shapes) {
+      tensor_size *= dim;
+    }
+    this->PrintIndent();
+    stream << "__ppl_tensor_info " << vid << " = {.shape = "
+           << vector2string(shapes)
+           << ", .stride = " << vector2string(buffer_stride[name])
+           << ", .addr = L2_SRAM_START_ADDR + " << addr
+           << ", .dtype = " << PPLDataType(op->dtype) << ", .mode = 2"
+           << ", .align_mode = 0"
+           << ", .size = " << tensor_size
+           << ", .unsigned_flag = 0, .default_stride = false};\n";
+    default_stride_[vid] = false;
+    this->PrintStmt(op->body);
+    return;
+  }
+   if (op->extents.size() == 4) {
+     // NCHW local tensor, e.g. a conv2d input/output tile
+     std::vector<int> shapes;
+     std::string bv_shape = "{";
+     int64_t tensor_size = (op->dtype.bits() + 7) / 8;
+     for (size_t i = 0; i < op->extents.size(); ++i) {
+       int dim = op->extents[i].as<IntImmNode>()->value;
+       shapes.push_back(dim);
+       tensor_size *= dim;
+       bv_shape += std::to_string(dim) + (i + 1 < op->extents.size() ? ", " : "}");
+     }
+     std::string vid = AllocVarID(op->buffer_var.get());
+     auto addr = f_attrs.GetAttr(vid, PrimExpr(0)).as<IntImmNode>()->value;
+     buffer_addrs_[op->buffer_var.get()] = addr;
+     this->PrintIndent();
+     stream << "__ppl_tensor_info " << vid << " = {.shape = " << bv_shape
+            << ", .stride = NULL"
+            << ", .addr = " << addr << ", .dtype = " << PPLDataType(op->dtype)
+            << ", .mode = 2"
+            << ", .align_mode = 1"
+            << ", .size = " << tensor_size / lane_num
+            << ", .unsigned_flag = 0, .default_stride = true};\n";
+     this->buffer_shape[vid] = shapes;
+     default_stride_[vid] = true;
+     this->PrintStmt(op->body);
+     return;
+   }
    auto buffer_shape = op->extents;
    if (buffer_shape.size() == 2)
      buffer_shape.insert(buffer_shape.begin(), make_const(DataType::Int(32), 1));
@@ -1681,15 +2839,8 @@ void CodeGenTileLangPPL::VisitStmt_(const AllocateNode *op) {
    bv_shape += ", 1, ";
    bv_shape += std::to_string(buffer_shape[2].as<IntImmNode>()->value);
    bv_shape += "}";
-   std::string op_dtype;
-   int bytes_size = 0;
-   if (op->dtype == DataType::Float(16)) {
-     op_dtype = "DT_FP16";
-     bytes_size = 2;
-  } else if (op->dtype == DataType::Float(32)) {
-     op_dtype = "DT_FP32";
-     bytes_size = 4;
-   }
+   std::string op_dtype = PPLDataType(op->dtype);
+   int bytes_size = (op->dtype.bits() + 7) / 8;
    auto buffer_num = buffer_shape[0].as<IntImmNode>()->value;
   for (size_t iter{0}; iter < buffer_num; iter++) {
      std::string vid = AllocVarID(op->buffer_var.get());
@@ -1704,6 +2855,7 @@ void CodeGenTileLangPPL::VisitStmt_(const AllocateNode *op) {
            << ", .size = " << tensor_size
            << ", .unsigned_flag = 0, .default_stride = true};\n";
       this->buffer_shape[vid] = shapes;
+      default_stride_[vid] = true;
       // store local tensor shape
     }
 
@@ -1864,11 +3016,17 @@ void CodeGenTileLangPPL::AddFunction(const PrimFunc &f) {
      shape_s += ", 1, ";
      shape_s += std::to_string(shape[1].as<IntImmNode>()->value);
      tensor_size *= shape[1].as<IntImmNode>()->value;
-    } else if (shape.size() == 4) {
-      buffer_shape[buffer_node->name] = {};
+    } else if (shape.size() == 4 || shape.size() == 1 || shape.size() == 3) {
+      // 1D/3D tensors (e.g. grouped gemm offsets and expert weights) are
+      // padded with leading unit dims
+      buffer_shape[buffer_node->name] =
+          std::vector<int>(4 - shape.size(), 1);
       for (auto s : shape) {
         buffer_shape[buffer_node->name].push_back(s.as<IntImmNode>()->value);
       }
+      for (size_t i = 0; i < 4 - shape.size(); ++i) {
+        shape_s += "1, ";
+      }
       default_stride(buffer_node->name);
       // 用下标循环来拼接带逗号的字符串
       for (size_t i = 0; i < shape.size(); ++i) {
@@ -1882,16 +3040,8 @@ void CodeGenTileLangPPL::AddFunction(const PrimFunc &f) {
     }
 
     shape_s += "}";
-     std::string dtype;
-     int bytes_size = 0;
- 
-    if (buffer_node->dtype == DataType::Float(16)) {
-       dtype = "DT_FP16";
-       bytes_size = 2;
-    } else if (buffer_node->dtype == DataType::Float(32)) {
-       dtype = "DT_FP32";
-       bytes_size = 4;
-     }
+     std::string dtype = PPLDataType(buffer_node->dtype);
+     int bytes_size = (buffer_node->dtype.bits() + 7) / 8;
      tensor_size *= bytes_size;
     std::string inst =
         "__ppl_tensor_info " + rid + " = {.shape = " + shape_s +
@@ -1899,6 +3049,7 @@ void CodeGenTileLangPPL::AddFunction(const PrimFunc &f) {
         ", .mode = 2, .align_mode = 0, .size = " + std::to_string(tensor_size) +
         ", .unsigned_flag = 0, .default_stride = true};\n";
      var_global_mem_map[v_node] = inst;
+    default_stride_[rid] = true;
      std::string name_hint = v_node->name_hint;
      this->var_idmap_[v_node] = rid;
  
@@ -1928,6 +3079,7 @@ void CodeGenTileLangPPL::AddFunction(const PrimFunc &f) {
      this->stream << inst;
    }
    this->PrintStmt(f->body);
+  SyncSDMA();
    this->EndScope(func_scope);
    this->PrintIndent();
    this->stream << "}\n\n";
@@ -1955,7 +3107,11 @@ void CodeGenTileLangPPL::AddFunction(const PrimFunc &f) {
      this->stream << "\n";
      name_index += 1;
    }
-   this->stream << "  tpu_poll();\n}\n";
+   this->stream << "  tpu_poll();\n";
+  if (profile_) {
+    this->stream << "  __ppl_prof_dump();\n";
+  }
+  this->stream << "}\n";
   this->stream << "TPUKERNEL_FUNC_REGISTER(" << global_name << "_kernel)\n";
  }
  
@@ -30,6 +30,7 @@
 
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "target/source/codegen_c.h"
 
@@ -70,6 +71,7 @@ class CodeGenTileLangPPL final : public CodeGenC {
   void VisitStmt_(const AllocateNode *op) final;
   void VisitStmt_(const AttrStmtNode *op) final;
   void VisitStmt_(const LetStmtNode *op) final;
+  void VisitStmt_(const EvaluateNode *op) final;
   void VisitExpr_(const FloorModNode *op, std::ostream &os);
 
   // Override this as a work around for __grid_constant__ parameter
@@ -93,6 +95,16 @@ class CodeGenTileLangPPL final : public CodeGenC {
   friend void PrintConst(const FloatImmNode *op, std::ostream &os,
                          CodeGenTileLangPPL *p);
   std::string AllocLocalVarID(const tir::VarNode *v);
+  // Emit tpu_sync_all_sdma() if an SDMA command issued earlier touches
+  // global buffer \p name, or any buffer when \p name is empty.
+  void SyncSDMA(const std::string &name = "");
+  // Emit tpu_sync_all_gdma() if a GDMA store issued earlier writes global
+  // buffer \p name, or any buffer when \p name is empty.
+  void SyncGDMA(const std::string &name = "");
+  // Stride argument of a BDC/GDMA call for descriptor \p tensor: NULL or
+  // &tensor.stride when its default_stride is known here, else the runtime
+  // test.
+  std::string StrideArg(const std::string &tensor) const;
   // The size of the barrier array in shared memory
   int barrier_count_ = -1;
   // whether need mma.h
@@ -122,6 +134,23 @@ class CodeGenTileLangPPL final : public CodeGenC {
   int32_t GetWmmaFragmentSize(const std::string &scope, const VarNode *variable,
                               int32_t size);
   int32_t gemm_idx_ = 0;
+  // tl.ppl_profile: emit __ppl_prof_begin/end around every ppl.* op
+  bool profile_{false};
+  // source text of each profiled op, indexed by its stmt id
+  std::vector<std::string> profile_stmts_;
+  // ppl.grouped_gemm was emitted, Finish() adds its tile scheduling helpers
+  bool grouped_gemm_{false};
+  // a ppl collective was emitted, Finish() adds the CDMA ring helpers
+  bool collective_{false};
+  // global buffers accessed by SDMA commands that were not waited for yet
+  std::unordered_set<std::string> sdma_pending_;
+  // global buffers written by GDMA stores that were not waited for yet
+  std::unordered_set<std::string> gdma_pending_;
+  // default_stride of the descriptors whose value is fixed at codegen time
+  std::unordered_map<std::string, bool> default_stride_;
+  // tl.region operand of a copy in the current loop nest -> the induction
+  // variable holding its global byte offset
+  std::unordered_map<const CallNode *, std::string> induction_offsets_;
 
   DictAttrs f_attrs;
 };
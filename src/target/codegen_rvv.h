@@ -36,6 +36,8 @@
 namespace tvm {
 namespace codegen {
 
+struct RVVElementwise;
+
 class CodeGenTileLangRVV final : public CodeGenC {
  public:
   CodeGenTileLangRVV();
@@ -70,6 +72,7 @@ class CodeGenTileLangRVV final : public CodeGenC {
   void VisitStmt_(const AllocateNode *op) final;
   void VisitStmt_(const AttrStmtNode *op) final;
   void VisitStmt_(const LetStmtNode *op) final;
+  void VisitStmt_(const SeqStmtNode *op) final;
   void VisitExpr_(const FloorModNode *op, std::ostream &os);
 
   // Override this as a work around for __grid_constant__ parameter
@@ -93,6 +96,26 @@ class CodeGenTileLangRVV final : public CodeGenC {
   friend void PrintConst(const FloatImmNode *op, std::ostream &os,
                          CodeGenTileLangRVV *p);
   std::string AllocLocalVarID(const tir::VarNode *v);
+  // Register-blocked micro-kernel for rvv.gemm
+  void PrintRVVGemm(const CallNode *op);
+  // rvv.reduce_max (is_max) or rvv.reduce_sum of a tile along one axis
+  void PrintRVVReduce(const CallNode *op, bool is_max);
+  // An rvv.add/sub/mul/div, rvv.*_C or rvv.<math> call as one elementwise
+  // step, false for any other statement
+  bool MatchRVVElementwise(const Stmt &stmt, RVVElementwise *ew);
+  // Elementwise steps on one tile as a single strip-mined loop
+  void PrintRVVElementwise(const std::vector<RVVElementwise> &ops);
+  // Whether a Tensor variable is a kernel parameter
+  bool IsGlobalTensor(const std::string &id) const;
+  // Elements of a buffer whose shape is known, -1 otherwise
+  int64_t KnownElements(const std::string &id) const;
+  // tl.rvv_min_vlen, the VLEN every target is assumed to have at least
+  int min_vlen_{128};
+  // tl.rvv_num_threads and tl.rvv_schedule for the block grid
+  int num_threads_{0};
+  std::string schedule_{"static"};
+  // set while printing the block loops under the omp pragma
+  bool in_block_grid_{false};
   // The size of the barrier array in shared memory
   int barrier_count_ = -1;
   // whether need mma.h
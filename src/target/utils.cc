@@ -17,6 +17,9 @@ bool TargetIsCuda(Target target) {
 bool TargetIsRocm(Target target) {
   return target->GetTargetDeviceType() == kDLROCM;
 }
+bool TargetIsCPU(Target target) {
+  return target->GetTargetDeviceType() == kDLCPU;
+}
 
 int GetArchInt(Target target) {
   auto s = target->GetAttr<String>("arch");
@@ -17,6 +17,7 @@ namespace tl {
 
 bool TargetIsCuda(Target target);
 bool TargetIsRocm(Target target);
+bool TargetIsCPU(Target target);
 
 bool TargetIsVolta(Target target);
 bool TargetIsTuring(Target target);
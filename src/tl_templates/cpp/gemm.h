@@ -2,4 +2,5 @@
 // Licensed under the MIT License.
 #pragma once
 
-// Not Implemented
+// T.gemm on the C/C++ backend lowers to tl::cpu::gemm_ss
+#include "../cpu/gemm.h"
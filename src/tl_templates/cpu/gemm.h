@@ -2,4 +2,191 @@
 // Licensed under the MIT License.
 #pragma once
 
-// Not Implemented
+// Tile-level GEMM for the C/C++ CPU backend, C (+)= op(A) * op(B) with A,
+// B and C dense row-major tiles of the shapes T.gemm checks. The operands are
+// packed into MR-row and NR-column panels converted to the accumulator type,
+// and an MR x NR register-blocked micro-kernel walks them. The vectors use the
+// GCC/Clang vector extensions at the widest width the compiler targets
+// (AVX-512, AVX2, or 128-bit SSE/NEON), so one source serves every host;
+// build with -O3 -march=native for the best of it.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace tl {
+namespace cpu {
+
+#if defined(__AVX512F__)
+#define TL_CPU_SIMD_BYTES 64
+#elif defined(__AVX__)
+#define TL_CPU_SIMD_BYTES 32
+#else
+#define TL_CPU_SIMD_BYTES 16
+#endif
+
+// accumulator rows of the micro-kernel: MR x 2 vectors of C plus the B
+// vectors and a broadcast A element have to fit the vector register file
+#if defined(__AVX512F__) || defined(__aarch64__)
+#define TL_CPU_GEMM_MR 8
+#else
+#define TL_CPU_GEMM_MR 6
+#endif
+
+// The vector of accumulator type T, undefined where the micro-kernel does not
+// apply and gemm_ss falls back to a scalar loop.
+template <typename T> struct SimdVec {
+  static constexpr bool kEnabled = false;
+};
+template <> struct SimdVec<float> {
+  static constexpr bool kEnabled = true;
+  typedef float type __attribute__((vector_size(TL_CPU_SIMD_BYTES)));
+};
+template <> struct SimdVec<double> {
+  static constexpr bool kEnabled = true;
+  typedef double type __attribute__((vector_size(TL_CPU_SIMD_BYTES)));
+};
+template <> struct SimdVec<int32_t> {
+  static constexpr bool kEnabled = true;
+  typedef int32_t type __attribute__((vector_size(TL_CPU_SIMD_BYTES)));
+};
+
+template <typename T> struct GemmConfig {
+  static constexpr int kLanes = TL_CPU_SIMD_BYTES / sizeof(T);
+  static constexpr int kMR = TL_CPU_GEMM_MR;
+  static constexpr int kNV = 2;
+  static constexpr int kNR = kNV * kLanes;
+};
+
+// element (i, k) of op(A) and (k, j) of op(B)
+template <int M, int K, bool trans_A, typename A_type>
+inline A_type load_a(const A_type *A, int i, int k) {
+  return trans_A ? A[k * M + i] : A[i * K + k];
+}
+template <int N, int K, bool trans_B, typename B_type>
+inline B_type load_b(const B_type *B, int k, int j) {
+  return trans_B ? B[j * K + k] : B[k * N + j];
+}
+
+// A as ceil(M / MR) panels of K x MR and B as ceil(N / NR) panels of K x NR,
+// zero past the edges so the micro-kernel never branches on them
+template <int M, int K, bool trans_A, typename Acc, typename A_type>
+inline void pack_a(const A_type *A, Acc *Ap) {
+  constexpr int MR = GemmConfig<Acc>::kMR;
+  for (int i0 = 0; i0 < M; i0 += MR) {
+    Acc *panel = Ap + i0 * K;
+    for (int k = 0; k < K; ++k) {
+      for (int i = 0; i < MR; ++i) {
+        panel[k * MR + i] = i0 + i < M ? static_cast<Acc>(
+                                             load_a<M, K, trans_A>(A, i0 + i, k))
+                                       : Acc(0);
+      }
+    }
+  }
+}
+
+template <int N, int K, bool trans_B, typename Acc, typename B_type>
+inline void pack_b(const B_type *B, Acc *Bp) {
+  constexpr int NR = GemmConfig<Acc>::kNR;
+  for (int j0 = 0; j0 < N; j0 += NR) {
+    Acc *panel = Bp + j0 * K;
+    for (int k = 0; k < K; ++k) {
+      for (int j = 0; j < NR; ++j) {
+        panel[k * NR + j] = j0 + j < N ? static_cast<Acc>(
+                                             load_b<N, K, trans_B>(B, k, j0 + j))
+                                       : Acc(0);
+      }
+    }
+  }
+}
+
+// C[0:rows, 0:cols] (+)= Ap * Bp for one MR x NR block; ldc is N
+template <int N, int K, bool clear_accum, typename Acc>
+inline void micro_kernel(const Acc *Ap, const Acc *Bp, Acc *C, int rows,
+                         int cols) {
+  typedef typename SimdVec<Acc>::type V;
+  constexpr int L = GemmConfig<Acc>::kLanes;
+  constexpr int MR = GemmConfig<Acc>::kMR;
+  constexpr int NV = GemmConfig<Acc>::kNV;
+  constexpr int NR = GemmConfig<Acc>::kNR;
+  V acc[MR][NV];
+  for (int i = 0; i < MR; ++i) {
+    for (int v = 0; v < NV; ++v) {
+      acc[i][v] = V{};
+    }
+  }
+  for (int k = 0; k < K; ++k) {
+    V b[NV];
+    for (int v = 0; v < NV; ++v) {
+      memcpy(&b[v], Bp + k * NR + v * L, sizeof(V));
+    }
+    for (int i = 0; i < MR; ++i) {
+      V a = V{} + Ap[k * MR + i];
+      for (int v = 0; v < NV; ++v) {
+        acc[i][v] += a * b[v];
+      }
+    }
+  }
+  for (int i = 0; i < rows; ++i) {
+    Acc *c = C + i * N;
+    if (cols == NR) {
+      for (int v = 0; v < NV; ++v) {
+        V out = acc[i][v];
+        if (!clear_accum) {
+          V old;
+          memcpy(&old, c + v * L, sizeof(V));
+          out += old;
+        }
+        memcpy(c + v * L, &out, sizeof(V));
+      }
+      continue;
+    }
+    Acc row[NR];
+    memcpy(row, acc[i], sizeof(row));
+    for (int j = 0; j < cols; ++j) {
+      c[j] = clear_accum ? row[j] : c[j] + row[j];
+    }
+  }
+}
+
+// C (+)= op(A) * op(B) for one tile, the whole tile on the calling thread.
+// Shapes: A is M x K (K x M if trans_A), B is K x N (N x K if trans_B), C is
+// M x N; the products are accumulated in C_type.
+template <int M, int N, int K, bool trans_A, bool trans_B, bool clear_accum,
+          typename A_type, typename B_type, typename C_type>
+inline void gemm_ss(A_type *pA, B_type *pB, C_type *pC) {
+  typedef C_type Acc;
+  if constexpr (SimdVec<Acc>::kEnabled) {
+    constexpr int MR = GemmConfig<Acc>::kMR;
+    constexpr int NR = GemmConfig<Acc>::kNR;
+    constexpr int Mp = (M + MR - 1) / MR * MR;
+    constexpr int Np = (N + NR - 1) / NR * NR;
+    // per thread, so blocks of a parallel grid do not share them
+    alignas(64) static thread_local Acc Ap[Mp * K];
+    alignas(64) static thread_local Acc Bp[Np * K];
+    pack_a<M, K, trans_A>(pA, Ap);
+    pack_b<N, K, trans_B>(pB, Bp);
+    for (int j0 = 0; j0 < N; j0 += NR) {
+      for (int i0 = 0; i0 < M; i0 += MR) {
+        micro_kernel<N, K, clear_accum>(Ap + i0 * K, Bp + j0 * K,
+                                        pC + i0 * N + j0,
+                                        M - i0 < MR ? M - i0 : MR,
+                                        N - j0 < NR ? N - j0 : NR);
+      }
+    }
+  } else {
+    for (int i = 0; i < M; ++i) {
+      for (int j = 0; j < N; ++j) {
+        Acc sum = clear_accum ? Acc(0) : pC[i * N + j];
+        for (int k = 0; k < K; ++k) {
+          sum += static_cast<Acc>(load_a<M, K, trans_A>(pA, i, k)) *
+                 static_cast<Acc>(load_b<N, K, trans_B>(pB, k, j));
+        }
+        pC[i * N + j] = sum;
+      }
+    }
+  }
+}
+
+} // namespace cpu
+} // namespace tl
@@ -0,0 +1,230 @@
+// Copyright (c) Tile-AI Corporation.
+// Licensed under the MIT License.
+#pragma once
+
+// Vectorised transcendentals for the RVV backend. Every function maps a
+// vfloat32m<L>_t / vfloat16m<L>_t over the first vl lanes, e.g.
+// tl_rvv_exp_f32m4(x, vl), so generated loops never leave the vector unit.
+//
+// The f32 versions use Cephes style range reduction and polynomials, within
+// 2 ulp over the normal range (log does not handle denormal inputs); gelu is
+// the tanh approximation. The f16 versions widen to f32 (Zvfh/Zvfhmin) and
+// narrow the result.
+
+#include <math.h>
+#include <riscv_vector.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TL_RVV_LN2_HI 0.693359375f
+#define TL_RVV_LN2_LO -2.12194440e-4f
+#define TL_RVV_LOG2E 1.44269504088896341f
+#define TL_RVV_SQRT_2_OVER_PI 0.7978845608028654f
+
+// L: LMUL suffix of the f32 vector (m1 .. m8), B: bits of its mask (32 .. 4)
+#define TL_RVV_DEFINE_MATH_F32(L, B)                                           \
+  /* y * 2^n for n in [-149, 128], scaled by two normal powers of two */       \
+  static inline vfloat32##L##_t tl_rvv_ldexp_f32##L(                           \
+      vfloat32##L##_t y, vint32##L##_t n, size_t vl) {                         \
+    vint32##L##_t h = __riscv_vsra_vx_i32##L(n, 1, vl);                        \
+    vfloat32##L##_t s0 = __riscv_vreinterpret_v_i32##L##_f32##L(               \
+        __riscv_vsll_vx_i32##L(__riscv_vadd_vx_i32##L(h, 127, vl), 23, vl));   \
+    vfloat32##L##_t s1 = __riscv_vreinterpret_v_i32##L##_f32##L(               \
+        __riscv_vsll_vx_i32##L(                                                \
+            __riscv_vadd_vx_i32##L(__riscv_vsub_vv_i32##L(n, h, vl), 127, vl), \
+            23, vl));                                                          \
+    return __riscv_vfmul_vv_f32##L(__riscv_vfmul_vv_f32##L(y, s0, vl), s1,     \
+                                   vl);                                        \
+  }                                                                            \
+  /* e^r for |r| <= ln2 / 2 */                                                 \
+  static inline vfloat32##L##_t tl_rvv_exp_poly_f32##L(vfloat32##L##_t r,      \
+                                                       size_t vl) {            \
+    vfloat32##L##_t p = __riscv_vfmv_v_f_f32##L(1.9875691500e-4f, vl);         \
+    p = __riscv_vfmadd_vv_f32##L(                                              \
+        p, r, __riscv_vfmv_v_f_f32##L(1.3981999507e-3f, vl), vl);              \
+    p = __riscv_vfmadd_vv_f32##L(                                              \
+        p, r, __riscv_vfmv_v_f_f32##L(8.3334519073e-3f, vl), vl);              \
+    p = __riscv_vfmadd_vv_f32##L(                                              \
+        p, r, __riscv_vfmv_v_f_f32##L(4.1665795894e-2f, vl), vl);              \
+    p = __riscv_vfmadd_vv_f32##L(                                              \
+        p, r, __riscv_vfmv_v_f_f32##L(1.6666665459e-1f, vl), vl);              \
+    p = __riscv_vfmadd_vv_f32##L(                                              \
+        p, r, __riscv_vfmv_v_f_f32##L(5.0000001201e-1f, vl), vl);              \
+    vfloat32##L##_t r2 = __riscv_vfmul_vv_f32##L(r, r, vl);                    \
+    p = __riscv_vfmadd_vv_f32##L(p, r2, r, vl);                                \
+    return __riscv_vfadd_vf_f32##L(p, 1.0f, vl);                               \
+  }                                                                            \
+  /* y = e^r * 2^n, inf above hi, 0 below lo and nan for nan x */              \
+  static inline vfloat32##L##_t tl_rvv_exp_finish_f32##L(                      \
+      vfloat32##L##_t x, vfloat32##L##_t r, vint32##L##_t n, float lo,         \
+      float hi, size_t vl) {                                                   \
+    vfloat32##L##_t y =                                                        \
+        tl_rvv_ldexp_f32##L(tl_rvv_exp_poly_f32##L(r, vl), n, vl);             \
+    y = __riscv_vfmerge_vfm_f32##L(                                            \
+        y, INFINITY, __riscv_vmfgt_vf_f32##L##_b##B(x, hi, vl), vl);           \
+    y = __riscv_vfmerge_vfm_f32##L(                                            \
+        y, 0.0f, __riscv_vmflt_vf_f32##L##_b##B(x, lo, vl), vl);               \
+    return __riscv_vfmerge_vfm_f32##L(                                         \
+        y, NAN, __riscv_vmfne_vv_f32##L##_b##B(x, x, vl), vl);                 \
+  }                                                                            \
+  static inline vfloat32##L##_t tl_rvv_exp_f32##L(vfloat32##L##_t x,           \
+                                                  size_t vl) {                 \
+    /* log(FLT_MAX) and log of the smallest denormal */                        \
+    const float hi = 88.7228391f, lo = -103.972084f;                           \
+    vfloat32##L##_t xc = __riscv_vfmax_vf_f32##L(                              \
+        __riscv_vfmin_vf_f32##L(x, hi, vl), lo, vl);                           \
+    vint32##L##_t n = __riscv_vfcvt_x_f_v_i32##L(                              \
+        __riscv_vfmul_vf_f32##L(xc, TL_RVV_LOG2E, vl), vl);                    \
+    vfloat32##L##_t fn = __riscv_vfcvt_f_x_v_f32##L(n, vl);                    \
+    vfloat32##L##_t r = __riscv_vfnmsac_vf_f32##L(xc, TL_RVV_LN2_HI, fn, vl);  \
+    r = __riscv_vfnmsac_vf_f32##L(r, TL_RVV_LN2_LO, fn, vl);                   \
+    return tl_rvv_exp_finish_f32##L(x, r, n, lo, hi, vl);                      \
+  }                                                                            \
+  static inline vfloat32##L##_t tl_rvv_exp2_f32##L(vfloat32##L##_t x,          \
+                                                   size_t vl) {                \
+    const float hi = 127.999992f, lo = -149.0f;                                \
+    vfloat32##L##_t xc = __riscv_vfmax_vf_f32##L(                              \
+        __riscv_vfmin_vf_f32##L(x, hi, vl), lo, vl);                           \
+    vint32##L##_t n = __riscv_vfcvt_x_f_v_i32##L(xc, vl);                      \
+    vfloat32##L##_t r = __riscv_vfmul_vf_f32##L(                               \
+        __riscv_vfsub_vv_f32##L(xc, __riscv_vfcvt_f_x_v_f32##L(n, vl), vl),    \
+        0.693147180559945f, vl);                                               \
+    return tl_rvv_exp_finish_f32##L(x, r, n, lo, hi, vl);                      \
+  }                                                                            \
+  static inline vfloat32##L##_t tl_rvv_log_f32##L(vfloat32##L##_t x,           \
+                                                  size_t vl) {                 \
+    /* x = m * 2^e with m in [sqrt(0.5), sqrt(2)) */                           \
+    vint32##L##_t bits = __riscv_vreinterpret_v_f32##L##_i32##L(x);            \
+    vint32##L##_t e = __riscv_vsub_vx_i32##L(                                  \
+        __riscv_vsra_vx_i32##L(bits, 23, vl), 126, vl);                        \
+    vfloat32##L##_t m = __riscv_vreinterpret_v_i32##L##_f32##L(                \
+        __riscv_vor_vx_i32##L(__riscv_vand_vx_i32##L(bits, 0x007fffff, vl),    \
+                              0x3f000000, vl));                                \
+    vbool##B##_t small = __riscv_vmflt_vf_f32##L##_b##B(m, 0.707106781186547f, \
+                                                       vl);                    \
+    e = __riscv_vsub_vx_i32##L##_mu(small, e, e, 1, vl);                       \
+    m = __riscv_vfadd_vv_f32##L##_mu(small, m, m, m, vl);                      \
+    m = __riscv_vfsub_vf_f32##L(m, 1.0f, vl);                                  \
+    vfloat32##L##_t fe = __riscv_vfcvt_f_x_v_f32##L(e, vl);                    \
+    vfloat32##L##_t z = __riscv_vfmul_vv_f32##L(m, m, vl);                     \
+    vfloat32##L##_t p = __riscv_vfmv_v_f_f32##L(7.0376836292e-2f, vl);         \
+    p = __riscv_vfmadd_vv_f32##L(                                              \
+        p, m, __riscv_vfmv_v_f_f32##L(-1.1514610310e-1f, vl), vl);             \
+    p = __riscv_vfmadd_vv_f32##L(                                              \
+        p, m, __riscv_vfmv_v_f_f32##L(1.1676998740e-1f, vl), vl);              \
+    p = __riscv_vfmadd_vv_f32##L(                                              \
+        p, m, __riscv_vfmv_v_f_f32##L(-1.2420140846e-1f, vl), vl);             \
+    p = __riscv_vfmadd_vv_f32##L(                                              \
+        p, m, __riscv_vfmv_v_f_f32##L(1.4249322787e-1f, vl), vl);              \
+    p = __riscv_vfmadd_vv_f32##L(                                              \
+        p, m, __riscv_vfmv_v_f_f32##L(-1.6668057665e-1f, vl), vl);             \
+    p = __riscv_vfmadd_vv_f32##L(                                              \
+        p, m, __riscv_vfmv_v_f_f32##L(2.0000714765e-1f, vl), vl);              \
+    p = __riscv_vfmadd_vv_f32##L(                                              \
+        p, m, __riscv_vfmv_v_f_f32##L(-2.4999993993e-1f, vl), vl);             \
+    p = __riscv_vfmadd_vv_f32##L(                                              \
+        p, m, __riscv_vfmv_v_f_f32##L(3.3333331174e-1f, vl), vl);              \
+    vfloat32##L##_t y = __riscv_vfmul_vv_f32##L(                               \
+        __riscv_vfmul_vv_f32##L(p, z, vl), m, vl);                             \
+    y = __riscv_vfmacc_vf_f32##L(y, TL_RVV_LN2_LO, fe, vl);                    \
+    y = __riscv_vfnmsac_vf_f32##L(y, 0.5f, z, vl);                             \
+    vfloat32##L##_t r = __riscv_vfadd_vv_f32##L(m, y, vl);                     \
+    r = __riscv_vfmacc_vf_f32##L(r, TL_RVV_LN2_HI, fe, vl);                    \
+    /* log(0) = -inf, log(x < 0) = nan, log(inf) = inf, log(nan) = nan */      \
+    r = __riscv_vfmerge_vfm_f32##L(                                            \
+        r, -INFINITY, __riscv_vmfle_vf_f32##L##_b##B(x, 0.0f, vl), vl);        \
+    r = __riscv_vfmerge_vfm_f32##L(                                            \
+        r, NAN, __riscv_vmflt_vf_f32##L##_b##B(x, 0.0f, vl), vl);              \
+    r = __riscv_vfmerge_vfm_f32##L(                                            \
+        r, INFINITY, __riscv_vmfeq_vf_f32##L##_b##B(x, INFINITY, vl), vl);     \
+    return __riscv_vfmerge_vfm_f32##L(                                         \
+        r, NAN, __riscv_vmfne_vv_f32##L##_b##B(x, x, vl), vl);                 \
+  }                                                                            \
+  static inline vfloat32##L##_t tl_rvv_rsqrt_f32##L(vfloat32##L##_t x,         \
+                                                    size_t vl) {               \
+    /* 7-bit estimate refined by two Newton steps y *= 1.5 - 0.5 x y^2 */      \
+    vfloat32##L##_t y0 = __riscv_vfrsqrt7_v_f32##L(x, vl);                     \
+    vfloat32##L##_t hx = __riscv_vfmul_vf_f32##L(x, 0.5f, vl);                 \
+    vfloat32##L##_t y = y0;                                                    \
+    for (int it = 0; it < 2; ++it) {                                           \
+      vfloat32##L##_t t = __riscv_vfmul_vv_f32##L(                             \
+          hx, __riscv_vfmul_vv_f32##L(y, y, vl), vl);                          \
+      y = __riscv_vfmul_vv_f32##L(y, __riscv_vfrsub_vf_f32##L(t, 1.5f, vl),    \
+                                  vl);                                         \
+    }                                                                          \
+    /* keep the exact estimate for 0 and inf, where Newton yields nan */       \
+    vbool##B##_t special = __riscv_vmor_mm_b##B(                               \
+        __riscv_vmfeq_vf_f32##L##_b##B(x, 0.0f, vl),                           \
+        __riscv_vmfeq_vf_f32##L##_b##B(x, INFINITY, vl), vl);                  \
+    return __riscv_vmerge_vvm_f32##L(y, y0, special, vl);                      \
+  }                                                                            \
+  static inline vfloat32##L##_t tl_rvv_sigmoid_f32##L(vfloat32##L##_t x,       \
+                                                      size_t vl) {             \
+    vfloat32##L##_t e = tl_rvv_exp_f32##L(__riscv_vfneg_v_f32##L(x, vl), vl);  \
+    return __riscv_vfrdiv_vf_f32##L(__riscv_vfadd_vf_f32##L(e, 1.0f, vl),      \
+                                    1.0f, vl);                                 \
+  }                                                                            \
+  static inline vfloat32##L##_t tl_rvv_tanh_f32##L(vfloat32##L##_t x,          \
+                                                   size_t vl) {                \
+    /* (1 - e^-2|x|) / (1 + e^-2|x|) with the sign of x */                     \
+    vfloat32##L##_t ax = __riscv_vfabs_v_f32##L(x, vl);                        \
+    vfloat32##L##_t e = tl_rvv_exp_f32##L(                                     \
+        __riscv_vfmul_vf_f32##L(ax, -2.0f, vl), vl);                           \
+    vfloat32##L##_t big = __riscv_vfdiv_vv_f32##L(                             \
+        __riscv_vfrsub_vf_f32##L(e, 1.0f, vl),                                 \
+        __riscv_vfadd_vf_f32##L(e, 1.0f, vl), vl);                             \
+    big = __riscv_vfsgnj_vv_f32##L(big, x, vl);                                \
+    /* odd polynomial below 0.625 where 1 - e^-2|x| cancels */                 \
+    vfloat32##L##_t z = __riscv_vfmul_vv_f32##L(x, x, vl);                     \
+    vfloat32##L##_t p = __riscv_vfmv_v_f_f32##L(-5.70498872745e-3f, vl);       \
+    p = __riscv_vfmadd_vv_f32##L(                                              \
+        p, z, __riscv_vfmv_v_f_f32##L(2.06390887954e-2f, vl), vl);             \
+    p = __riscv_vfmadd_vv_f32##L(                                              \
+        p, z, __riscv_vfmv_v_f_f32##L(-5.37397155531e-2f, vl), vl);            \
+    p = __riscv_vfmadd_vv_f32##L(                                              \
+        p, z, __riscv_vfmv_v_f_f32##L(1.33314422036e-1f, vl), vl);             \
+    p = __riscv_vfmadd_vv_f32##L(                                              \
+        p, z, __riscv_vfmv_v_f_f32##L(-3.33332819422e-1f, vl), vl);            \
+    vfloat32##L##_t small = __riscv_vfmacc_vv_f32##L(                          \
+        x, __riscv_vfmul_vv_f32##L(p, z, vl), x, vl);                          \
+    return __riscv_vmerge_vvm_f32##L(                                          \
+        big, small, __riscv_vmflt_vf_f32##L##_b##B(ax, 0.625f, vl), vl);       \
+  }                                                                            \
+  static inline vfloat32##L##_t tl_rvv_gelu_f32##L(vfloat32##L##_t x,          \
+                                                   size_t vl) {                \
+    /* tanh approximation, 0.5 x (1 + tanh(u)) = x * sigmoid(2u) */            \
+    vfloat32##L##_t x3 = __riscv_vfmul_vv_f32##L(                              \
+        __riscv_vfmul_vv_f32##L(x, x, vl), x, vl);                             \
+    vfloat32##L##_t u = __riscv_vfmacc_vf_f32##L(x, 0.044715f, x3, vl);        \
+    u = __riscv_vfmul_vf_f32##L(u, 2.0f * TL_RVV_SQRT_2_OVER_PI, vl);          \
+    return __riscv_vfmul_vv_f32##L(x, tl_rvv_sigmoid_f32##L(u, vl), vl);       \
+  }                                                                            \
+
+TL_RVV_DEFINE_MATH_F32(m1, 32)
+TL_RVV_DEFINE_MATH_F32(m2, 16)
+TL_RVV_DEFINE_MATH_F32(m4, 8)
+TL_RVV_DEFINE_MATH_F32(m8, 4)
+
+#if defined(__riscv_zvfh) || defined(__riscv_zvfhmin)
+// H: LMUL suffix of the f16 vector, L: that of the widened f32 vector
+#define TL_RVV_DEFINE_UNARY_F16(NAME, H, L)                                    \
+  static inline vfloat16##H##_t tl_rvv_##NAME##_f16##H(vfloat16##H##_t x,      \
+                                                       size_t vl) {            \
+    return __riscv_vfncvt_f_f_w_f16##H(                                        \
+        tl_rvv_##NAME##_f32##L(__riscv_vfwcvt_f_f_v_f32##L(x, vl), vl), vl);   \
+  }
+
+#define TL_RVV_DEFINE_MATH_F16(H, L)                                           \
+  TL_RVV_DEFINE_UNARY_F16(exp, H, L)                                           \
+  TL_RVV_DEFINE_UNARY_F16(exp2, H, L)                                          \
+  TL_RVV_DEFINE_UNARY_F16(log, H, L)                                           \
+  TL_RVV_DEFINE_UNARY_F16(rsqrt, H, L)                                         \
+  TL_RVV_DEFINE_UNARY_F16(sigmoid, H, L)                                       \
+  TL_RVV_DEFINE_UNARY_F16(tanh, H, L)                                          \
+  TL_RVV_DEFINE_UNARY_F16(gelu, H, L)
+
+TL_RVV_DEFINE_MATH_F16(mf2, m1)
+TL_RVV_DEFINE_MATH_F16(m1, m2)
+TL_RVV_DEFINE_MATH_F16(m2, m4)
+TL_RVV_DEFINE_MATH_F16(m4, m8)
+#endif
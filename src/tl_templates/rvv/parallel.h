@@ -0,0 +1,42 @@
+// Copyright (c) Tile-AI Corporation.
+// Licensed under the MIT License.
+#pragma once
+
+// Multi-hart support for the RVV backend. The codegen spreads the block grid
+// of a kernel over the harts with "#pragma omp parallel for"; build the kernel
+// with -fopenmp to enable it, without it the pragmas are ignored and the grid
+// runs serially on one hart.
+
+#include <stddef.h>
+#include <string.h>
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+#define TL_RVV_PAGE_BYTES 4096
+// smaller copies are not worth waking the other harts for
+#define TL_RVV_PARALLEL_COPY_MIN_PAGES 16
+
+// memcpy of the kernel parameters into and out of their working copies. The
+// pages are split into one contiguous range per hart, the same partition a
+// static schedule gives the block grid, so with first-touch page placement the
+// rows a hart's blocks work on are local to that hart. threads is
+// tl.rvv_num_threads, 0 for all harts.
+static inline void tl_rvv_parallel_copy(void *dst, const void *src, size_t n,
+                                        int threads) {
+#if defined(_OPENMP)
+  long pages = (long)((n + TL_RVV_PAGE_BYTES - 1) / TL_RVV_PAGE_BYTES);
+  if (threads != 1 && pages >= TL_RVV_PARALLEL_COPY_MIN_PAGES) {
+    int nt = threads > 0 ? threads : omp_get_max_threads();
+#pragma omp parallel for schedule(static) num_threads(nt)
+    for (long p = 0; p < pages; ++p) {
+      size_t off = (size_t)p * TL_RVV_PAGE_BYTES;
+      size_t len = n - off < TL_RVV_PAGE_BYTES ? n - off : TL_RVV_PAGE_BYTES;
+      memcpy((char *)dst + off, (const char *)src + off, len);
+    }
+    return;
+  }
+#endif
+  (void)threads;
+  memcpy(dst, src, n);
+}
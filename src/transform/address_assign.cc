@@ -35,6 +35,7 @@
 #include <tvm/tir/transform.h>
 
 // #include <map>
+#include <algorithm>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -64,6 +65,81 @@ class AddressAllocator : public StmtExprVisitor {
   std::vector<const BufferNode *> alloc_ops_;
 };
 
+/*!
+ * \brief Live interval of every buffer in statement order, for the memory
+ * plan report.
+ *
+ * Every Evaluate/BufferStore is one step. A buffer touched inside a loop that
+ * does not contain its declaration stays live for the whole loop, since it
+ * carries data across iterations.
+ */
+class LiveIntervalCollector : public StmtExprVisitor {
+public:
+  std::unordered_map<const VarNode *, std::pair<int, int>> intervals;
+  int steps = 0;
+
+private:
+  struct LoopSpan {
+    int start;
+    std::unordered_set<const VarNode *> touched;
+  };
+
+  void VisitStmt_(const DeclBufferNode *op) final {
+    decl_depth_[op->buffer->data.get()] = loops_.size();
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitStmt_(const ForNode *op) final {
+    loops_.push_back({steps, {}});
+    StmtExprVisitor::VisitStmt_(op);
+    for (const VarNode *v : loops_.back().touched) {
+      intervals[v].second = std::max(intervals[v].second, steps - 1);
+    }
+    loops_.pop_back();
+  }
+
+  void VisitStmt_(const EvaluateNode *op) final {
+    StmtExprVisitor::VisitStmt_(op);
+    ++steps;
+  }
+
+  void VisitStmt_(const BufferStoreNode *op) final {
+    Touch(op->buffer->data.get());
+    StmtExprVisitor::VisitStmt_(op);
+    ++steps;
+  }
+
+  void VisitExpr_(const BufferLoadNode *op) final {
+    Touch(op->buffer->data.get());
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  void VisitExpr_(const VarNode *op) final { Touch(op); }
+
+  void Touch(const VarNode *v) {
+    auto it = decl_depth_.find(v);
+    if (it == decl_depth_.end()) {
+      return;
+    }
+    int start = steps;
+    if (loops_.size() > it->second) {
+      LoopSpan &loop = loops_[it->second];
+      start = loop.start;
+      loop.touched.insert(v);
+    }
+    auto iv = intervals.find(v);
+    if (iv == intervals.end()) {
+      intervals[v] = {start, steps};
+    } else {
+      iv->second.first = std::min(iv->second.first, start);
+      iv->second.second = std::max(iv->second.second, steps);
+    }
+  }
+
+  std::unordered_map<const VarNode *, size_t> decl_depth_;
+  std::vector<LoopSpan> loops_;
+};
+
 struct TensorLive {
   int start, end;
   uint32_t tensor_size;
@@ -101,7 +177,10 @@ class MemAllocBankConflictAware {
       std::unordered_map<const BufferNode *,
                          std::unordered_set<const BufferNode *>> &conflictMap,
       std::unordered_map<const BufferNode *, int64_t> &addrMap,
-      int64_t &totalSize) {
+      int64_t &totalSize,
+      const std::unordered_map<const BufferNode *,
+                               std::unordered_set<const BufferNode *>>
+          &siblingMap = {}) {
     std::list<const BufferNode *> op_list;
       std::copy(ops.begin(), ops.end(), std::back_inserter(op_list));
       
@@ -111,6 +190,12 @@ class MemAllocBankConflictAware {
       for (auto &op : op_list) {
         std::shared_ptr<OpAddr> best_addr;
         int64_t min_conflict_count = std::numeric_limits<int64_t>::max();
+        // pipeline versions of one buffer must not share a bank, relax it
+        // only when no such placement exists
+        for (bool strict : {true, false}) {
+        if (best_addr || (!strict && !siblingMap.count(op))) {
+          break;
+        }
         for (int i = 0; i < bank_num_; ++i) {
           int64_t offset = i * bank_size_;
         int64_t mem_cross_bank_num = std::ceil(
@@ -123,6 +208,9 @@ class MemAllocBankConflictAware {
       
           // op can insert
           if (op_addr->start + op_addr->size < std::min(end_offset, mem_size_)) {
+            if (strict && getConflictCount(op_addr, siblingMap) > 0) {
+              continue;
+            }
             int64_t conf_count = getConflictCount(op_addr, conflictMap);
             if (conf_count < min_conflict_count) {
               min_conflict_count = conf_count;
@@ -130,6 +218,7 @@ class MemAllocBankConflictAware {
             }
           }
         }
+        }
         if (!best_addr) {
           std::cout << "Errrror" << std::endl;
           return false;
@@ -160,14 +249,19 @@ class MemAllocBankConflictAware {
   
   int64_t getConflictCount(
       std::shared_ptr<OpAddr> &opAddr,
-      std::unordered_map<const BufferNode *,
-                         std::unordered_set<const BufferNode *>> &conflictMap) {
+      const std::unordered_map<const BufferNode *,
+                               std::unordered_set<const BufferNode *>>
+          &conflictMap) {
+      auto conflicts = conflictMap.find(opAddr->op);
+      if (conflicts == conflictMap.end()) {
+        return 0;
+      }
       int64_t bank_start = opAddr->start / bank_size_;
       int64_t bank_end = opAddr->end / bank_size_;
       int count = 0;
       for (int i = bank_start; i <= bank_end; i++) {
         for (auto op : bank_ops[i]) {
-          if (conflictMap[opAddr->op].count(op)) {
+          if (conflicts->second.count(op)) {
             ++count;
           }
         }
@@ -219,13 +313,174 @@ protected:
   int64_t mem_size_;
 };
 
+// Function attribute holding the placement report built by MemoryPlan.
+static constexpr const char *kMemoryPlan = "tl.memory_plan";
+
+// L2 SRAM of bm1690, shared by all cores; other chips set tl.ppl_l2_sram_size.
+static constexpr int64_t kBM1690L2SramSize = 128 * 1024 * 1024;
+static constexpr int64_t kL2SramAlign = 128;
+
+static int64_t L2SramSize() {
+  return tvm::transform::PassContext::Current()
+      ->GetConfig<Integer>(kPPLL2SramSize, Integer(kBM1690L2SramSize))
+      .value()
+      ->value;
+}
+
+static bool IsL2Buffer(const BufferNode *op) {
+  std::string scope = GetRef<Buffer>(op).scope();
+  return scope == "shared.l2" || scope == "global.l2";
+}
+
+/*!
+ * \brief Place shared.l2/global.l2 buffers in the L2 SRAM.
+ *
+ * Every core runs the same kernel and must see the same L2 tensor, so the
+ * buffers are laid out one after another for the whole kernel instead of
+ * sharing space by liveness.
+ */
+static int64_t L2Bytes(const BufferNode *op) {
+  int64_t size = (op->dtype.bits() * op->dtype.lanes() + 7) / 8;
+  for (const PrimExpr &s : op->shape) {
+    size *= s.as<IntImmNode>()->value;
+  }
+  return size;
+}
+
+static std::unordered_map<const BufferNode *, int64_t>
+AssignL2Address(const std::vector<const BufferNode *> &ops, int64_t l2_size) {
+  std::unordered_map<const BufferNode *, int64_t> addr_map;
+  int64_t offset = 0;
+  for (const BufferNode *op : ops) {
+    int64_t size = L2Bytes(op);
+    addr_map[op] = offset;
+    offset += (size + kL2SramAlign - 1) / kL2SramAlign * kL2SramAlign;
+  }
+  ICHECK_LE(offset, l2_size)
+      << "L2 buffers need " << offset << " bytes, the L2 SRAM has " << l2_size;
+  return addr_map;
+}
+
+/*!
+ * \brief Structured view of the placement, attached as "tl.memory_plan".
+ *
+ * Per local buffer: NPU-local address (-1 if it did not fit), reserved bytes,
+ * bank range and live interval in statement steps; totals against the local
+ * memory capacity and the buffers live at the peak step. L2 buffers are listed
+ * with their offset in the L2 SRAM.
+ *
+ * The live intervals and the peak are an estimate from the statement order:
+ * the allocator keeps every local buffer live for the whole kernel and apart
+ * from all others, so addresses never overlap. The plan says so in
+ * "live_estimated".
+ */
+static Map<String, ObjectRef> MemoryPlan(
+    const Stmt &body, const std::vector<const BufferNode *> &alloc_ops,
+    std::unordered_map<const BufferNode *, TensorLive> &live_ranges,
+    std::unordered_map<const BufferNode *, int64_t> &addr_map,
+    const std::vector<const BufferNode *> &l2_ops,
+    const std::unordered_map<const BufferNode *, int64_t> &l2_addr_map,
+    bool success, int64_t used, int bank_num, int bank_size, int64_t l2_size) {
+  LiveIntervalCollector live;
+  live(body);
+  auto interval = [&live](const BufferNode *op) {
+    auto it = live.intervals.find(op->data.get());
+    return it == live.intervals.end() ? std::make_pair(0, 0) : it->second;
+  };
+
+  Array<ObjectRef> buffers;
+  int64_t buffer_bytes = 0;
+  std::vector<bool> bank_used(bank_num, false);
+  for (const BufferNode *op : alloc_ops) {
+    int64_t size = live_ranges[op].tensor_size;
+    int64_t addr = addr_map.count(op) ? addr_map[op] : -1;
+    auto [start, end] = interval(op);
+    Map<String, ObjectRef> entry;
+    entry.Set("name", String(op->name));
+    entry.Set("dtype", String(runtime::DLDataType2String(op->dtype)));
+    entry.Set("shape", op->shape);
+    entry.Set("addr", Integer(addr));
+    entry.Set("size", Integer(size));
+    if (addr >= 0) {
+      int64_t bank_start = addr / bank_size;
+      int64_t bank_end = (addr + std::max<int64_t>(size, 1) - 1) / bank_size;
+      for (int64_t b = bank_start; b <= bank_end && b < bank_num; ++b) {
+        bank_used[b] = true;
+      }
+      entry.Set("bank_start", Integer(bank_start));
+      entry.Set("bank_end", Integer(bank_end));
+    }
+    entry.Set("live_start", Integer(start));
+    entry.Set("live_end", Integer(end));
+    buffers.push_back(entry);
+    buffer_bytes += size;
+  }
+
+  // the step with the most bytes live and who holds them
+  int64_t peak_bytes = 0;
+  int peak_step = 0;
+  for (int t = 0; t < std::max(live.steps, 1); ++t) {
+    int64_t bytes = 0;
+    for (const BufferNode *op : alloc_ops) {
+      auto [start, end] = interval(op);
+      if (start <= t && t <= end) {
+        bytes += live_ranges[op].tensor_size;
+      }
+    }
+    if (bytes > peak_bytes) {
+      peak_bytes = bytes;
+      peak_step = t;
+    }
+  }
+  Array<String> peak_buffers;
+  for (const BufferNode *op : alloc_ops) {
+    auto [start, end] = interval(op);
+    if (start <= peak_step && peak_step <= end) {
+      peak_buffers.push_back(op->name);
+    }
+  }
+
+  Array<ObjectRef> l2_buffers;
+  for (const BufferNode *op : l2_ops) {
+    Map<String, ObjectRef> entry;
+    entry.Set("name", String(op->name));
+    entry.Set("dtype", String(runtime::DLDataType2String(op->dtype)));
+    entry.Set("shape", op->shape);
+    entry.Set("addr", Integer(l2_addr_map.at(op)));
+    entry.Set("size", Integer(L2Bytes(op)));
+    l2_buffers.push_back(entry);
+  }
+
+  Map<String, ObjectRef> plan;
+  plan.Set("success", Bool(success));
+  plan.Set("bank_num", Integer(bank_num));
+  plan.Set("bank_size", Integer(bank_size));
+  plan.Set("capacity", Integer(static_cast<int64_t>(bank_num) * bank_size));
+  plan.Set("used", Integer(used));
+  plan.Set("buffer_bytes", Integer(buffer_bytes));
+  plan.Set("banks_used", Integer(std::count(bank_used.begin(),
+                                            bank_used.end(), true)));
+  plan.Set("live_estimated", Bool(true));
+  plan.Set("steps", Integer(live.steps));
+  plan.Set("peak_step", Integer(peak_step));
+  plan.Set("peak_bytes", Integer(peak_bytes));
+  plan.Set("peak_buffers", peak_buffers);
+  plan.Set("buffers", buffers);
+  plan.Set("l2_capacity", Integer(l2_size));
+  plan.Set("l2_buffers", l2_buffers);
+  return plan;
+}
+
 PrimFunc InferAddress(PrimFunc f) {
   int bank_num = 16, bank_size = 16 * 1024;
+  int64_t l2_size = L2SramSize();
   std::unordered_map<const BufferNode *, std::unordered_set<const BufferNode *>>
       bank_conflict_map;
   std::unordered_map<const BufferNode *, TensorLive> live_ranges;
-  std::vector<const BufferNode *> alloc_ops =
-      AddressAllocator().collectAllocOp(f->body);
+  std::vector<const BufferNode *> alloc_ops, l2_ops;
+  for (const BufferNode *op : AddressAllocator().collectAllocOp(f->body)) {
+    (IsL2Buffer(op) ? l2_ops : alloc_ops).push_back(op);
+  }
   // for (auto &op : alloc_ops) {
   //   bank_conflict_map.Set(op, {});
   // }
@@ -249,22 +504,48 @@ PrimFunc InferAddress(PrimFunc f) {
       op_size *= ss;
     }
     op_size /= bank_num;
-    int bytes_size = 1;
-    if (dtype == DataType::Float(16)) {
-      bytes_size = 2;
-    } else if (dtype == DataType::Float(32)) {
-      bytes_size = 4;
-    }
+    // int32 conv accumulators and bf16 tiles need their real width too
+    int bytes_size = (dtype.bits() * dtype.lanes() + 7) / 8;
     op_size *= bytes_size;
     // live_ranges.Set(op, {1, 4, op_size});
     live_ranges[op] = {1, 4, op_size};
   }
 
+  // UnrollPipelineVersions records the versions of every pipelined buffer;
+  // versions are written by GDMA while a sibling is read by BDC, so they are
+  // kept in distinct banks.
+  std::unordered_map<const BufferNode *, std::unordered_set<const BufferNode *>>
+      sibling_map;
+  std::unordered_map<std::string, const BufferNode *> op_by_data;
+  for (auto &op : alloc_ops) {
+    op_by_data[op->data->name_hint] = op;
+  }
+  auto groups = f->GetAttr<Array<Array<String>>>(kPipelineVersions)
+                    .value_or(Array<Array<String>>());
+  for (const auto &group : groups) {
+    std::vector<const BufferNode *> versions;
+    for (const auto &name : group) {
+      auto it = op_by_data.find(name);
+      if (it != op_by_data.end()) {
+        versions.push_back(it->second);
+      }
+    }
+    for (auto &op : versions) {
+      for (auto &op2 : versions) {
+        if (op != op2 && op->dtype == op2->dtype &&
+            StructuralEqual()(op->shape, op2->shape)) {
+          sibling_map[op].insert(op2);
+        }
+      }
+    }
+  }
+
   std::unordered_map<const BufferNode *, int64_t> addrMapWithBC;
   int64_t memUsedWithBC = 0;
   MemAllocBankConflictAware allocatorBC(bank_num, bank_size);
-  auto success = allocatorBC.assignAddr(
-      alloc_ops, live_ranges, bank_conflict_map, addrMapWithBC, memUsedWithBC);
+  auto success =
+      allocatorBC.assignAddr(alloc_ops, live_ranges, bank_conflict_map,
+                             addrMapWithBC, memUsedWithBC, sibling_map);
   
   if (success) {
     // std::unordered_map<String, PrimExpr> result;
@@ -275,7 +556,23 @@ PrimFunc InferAddress(PrimFunc f) {
       fn_attr->dict.Set(op->name, PrimExpr(address));
     }
   }
-  return f;
+  std::unordered_map<const BufferNode *, int64_t> l2_addr_map;
+  if (!l2_ops.empty()) {
+    l2_addr_map = AssignL2Address(l2_ops, l2_size);
+    auto fn = f.CopyOnWrite();
+    auto fn_attr = fn->attrs.CopyOnWrite();
+    for (auto &kv : l2_addr_map) {
+      // offsets from L2_SRAM_START_ADDR
+      fn_attr->dict.Set(kv.first->name,
+                        PrimExpr(static_cast<int32_t>(kv.second)));
+    }
+  }
+  // a failed placement keeps the buffers placed before the one that did not
+  // fit, which is the one blocking a larger tile
+  auto plan = MemoryPlan(f->body, alloc_ops, live_ranges, addrMapWithBC, l2_ops,
+                         l2_addr_map, success, memUsedWithBC, bank_num,
+                         bank_size, l2_size);
+  return WithAttr(std::move(f), kMemoryPlan, plan);
 }
 
 tvm::transform::Pass AddressAssign() {
@@ -0,0 +1,579 @@
+// Copyright (c) Tile-AI Corporation.
+// Licensed under the MIT License.
+/*!
+ * \file fuse_ppl_elementwise.cc
+ * \brief Fuse chains of ppl.* elementwise tile ops and shrink their
+ * temporaries.
+ *
+ * The rewrites only look at consecutive `ppl.*` calls in a SeqStmt:
+ *  - scalar folding: `mul_C(t, x, a); mul_C(y, t, b)` becomes
+ *    `mul_C(y, x, a * b)` (same for add_C), and a binary op whose operand was
+ *    only ever filled with a constant becomes the `_C` variant;
+ *  - in-place execution: `op1(t, ...); op2(y, t, ...)` writes `y` directly
+ *    when `t` is a temporary that is dead afterwards;
+ *  - scratch sharing: the work/coeff/table operands of ppl.exp are never live
+ *    across calls, so every call uses the largest one of each kind.
+ * Buffers that end up unused are dropped, so AddressAssign does not reserve
+ * local memory for them.
+ */
+
+#include <tvm/tir/analysis.h>
+#include <tvm/tir/builtin.h>
+#include <tvm/tir/op.h>
+#include <tvm/tir/stmt_functor.h>
+#include <tvm/tir/transform.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <tuple>
+
+#include "../op/builtin.h"
+#include "../op/op.h"
+
+namespace tvm {
+namespace tl {
+
+using namespace tir;
+
+namespace {
+
+struct PPLElementwiseInfo {
+  // operand index of the destination, -1 for none
+  int dst;
+  // operand indices read by the op
+  std::vector<int> srcs;
+  // operand index of the scalar for the _C variants, -1 for none
+  int scalar;
+};
+
+const std::unordered_map<std::string, PPLElementwiseInfo> &
+ElementwiseTable() {
+  static const std::unordered_map<std::string, PPLElementwiseInfo> table = {
+      {"ppl.add", {1, {2, 3}, -1}},   {"ppl.sub", {1, {2, 3}, -1}},
+      {"ppl.mul", {1, {2, 3}, -1}},   {"ppl.div", {1, {2, 3}, -1}},
+      {"ppl.add_C", {1, {2}, 3}},     {"ppl.mul_C", {1, {2}, 3}},
+      {"ppl.rsqrt", {1, {2}, -1}},
+  };
+  return table;
+}
+
+// Scratch operands of ppl.exp: (operand index, sharing class).
+const std::vector<std::pair<int, std::string>> &ExpScratchOperands() {
+  static const std::vector<std::pair<int, std::string>> operands = {
+      {2, "work0"}, {3, "work1"}, {4, "coeff"}, {5, "table"}};
+  return operands;
+}
+
+const CallNode *AsPPLCall(const Stmt &stmt, std::string *name) {
+  const auto *eval = stmt.as<EvaluateNode>();
+  if (!eval)
+    return nullptr;
+  const auto *call = eval->value.as<CallNode>();
+  if (!call || !call->op.same_as(builtin::call_extern()) ||
+      call->args.empty() || !call->args[0].as<StringImmNode>())
+    return nullptr;
+  std::string op_name = Downcast<StringImm>(call->args[0])->value;
+  if (op_name.rfind("ppl.", 0) != 0)
+    return nullptr;
+  *name = op_name;
+  return call;
+}
+
+Array<PrimExpr> Operands(const CallNode *call) {
+  Array<PrimExpr> operands;
+  for (size_t i = 1; i < call->args.size(); ++i)
+    operands.push_back(call->args[i]);
+  return operands;
+}
+
+const VarNode *PtrVar(const PrimExpr &arg) {
+  const auto *ptr = arg.as<CallNode>();
+  if (!ptr || !ptr->op.same_as(builtin::tvm_access_ptr()))
+    return nullptr;
+  return ptr->args[1].as<VarNode>();
+}
+
+// Only whole-buffer accesses are moved to another buffer.
+bool IsWholeBuffer(const PrimExpr &arg) {
+  const auto *ptr = arg.as<CallNode>();
+  return ptr && is_zero(ptr->args[2]);
+}
+
+// Re-point an access_ptr at another buffer, keeping its access mask.
+PrimExpr RetargetPtr(const PrimExpr &arg, const Buffer &buffer) {
+  const auto *ptr = arg.as<CallNode>();
+  Array<PrimExpr> args = ptr->args;
+  PrimExpr extent = make_const(DataType::Int(32), 1);
+  for (const PrimExpr &s : buffer->shape)
+    extent = extent * s;
+  args.Set(1, buffer->data);
+  args.Set(2, make_zero(DataType::Int(32)));
+  args.Set(3, arith::Analyzer().Simplify(extent));
+  return Call(ptr->dtype, ptr->op, args, ptr->span);
+}
+
+Stmt MakePPLCall(const CallNode *call, const std::string &name,
+                 const Array<PrimExpr> &operands) {
+  Array<PrimExpr> args{StringImm(name)};
+  for (const PrimExpr &e : operands)
+    args.push_back(e);
+  return Evaluate(Call(call->dtype, call->op, args, call->span));
+}
+
+/*! \brief Count every reference to a buffer data var in the function. */
+class BufferUseCounter : public StmtExprVisitor {
+public:
+  std::unordered_map<const VarNode *, int> count;
+  std::unordered_map<const VarNode *, Buffer> buffers;
+  std::unordered_map<const VarNode *, const BlockNode *> owner;
+
+private:
+  void VisitExpr_(const VarNode *op) final { ++count[op]; }
+  void VisitExpr_(const BufferLoadNode *op) final {
+    ++count[op->buffer->data.get()];
+    StmtExprVisitor::VisitExpr_(op);
+  }
+  void VisitStmt_(const BufferStoreNode *op) final {
+    ++count[op->buffer->data.get()];
+    StmtExprVisitor::VisitStmt_(op);
+  }
+  void VisitStmt_(const BlockNode *op) final {
+    for (const Buffer &buf : op->alloc_buffers) {
+      buffers[buf->data.get()] = buf;
+      owner[buf->data.get()] = op;
+    }
+    StmtExprVisitor::VisitStmt_(op);
+  }
+};
+
+int CountInStmt(const Stmt &stmt, const VarNode *var) {
+  BufferUseCounter counter;
+  counter(stmt);
+  return counter.count.count(var) ? counter.count.at(var) : 0;
+}
+
+class PPLElementwiseFuser : public StmtExprMutator {
+public:
+  explicit PPLElementwiseFuser(const Stmt &body) {
+    uses_(body);
+    // buffers whose only writer is a dominating ppl.fill with a constant
+    ConstFillCollector fills;
+    fills(body);
+    const_fills_ = std::move(fills.value);
+  }
+
+  bool changed = false;
+
+private:
+  /*!
+   * \brief Buffers filled with a constant by a ppl.fill that dominates every
+   * other access: it is not under an if or a loop inside the buffer's scope,
+   * nothing references the buffer before it, and nothing writes the buffer
+   * after it.
+   */
+  class ConstFillCollector : public StmtExprVisitor {
+  public:
+    std::unordered_map<const VarNode *, FloatImm> value;
+
+  private:
+    void VisitStmt_(const EvaluateNode *op) final {
+      std::string name;
+      const CallNode *call = AsPPLCall(GetRef<Stmt>(op), &name);
+      if (!call) {
+        StmtExprVisitor::VisitStmt_(op);
+        return;
+      }
+      if (name == "ppl.fill" && call->args[2].as<FloatImmNode>()) {
+        const VarNode *var = PtrVar(call->args[1]);
+        auto scope = alloc_depth_.find(var);
+        if (var && !seen_use_.count(var) && scope != alloc_depth_.end() &&
+            scope->second == nest_depth_)
+          value[var] = Downcast<FloatImm>(call->args[2]);
+        else
+          value.erase(var);
+        seen_use_.insert(var);
+        return;
+      }
+      // any other op that may write the buffer disqualifies it
+      auto it = ElementwiseTable().find(name);
+      for (size_t i = 1; i < call->args.size(); ++i) {
+        const VarNode *var = PtrVar(call->args[i]);
+        if (!var) {
+          // tl.region operands (ppl.copy, ppl.transpose, ppl.stage_l2, ...)
+          // carry no access mask here, any of them may be the destination
+          const auto *region = call->args[i].as<CallNode>();
+          if (region && region->op.same_as(RegionOp::Get())) {
+            if (const auto *load = region->args[0].as<BufferLoadNode>())
+              value.erase(load->buffer->data.get());
+          }
+          VisitExpr(call->args[i]);
+          continue;
+        }
+        bool read_only = it != ElementwiseTable().end() &&
+                         static_cast<int>(i) != it->second.dst;
+        if (!read_only)
+          value.erase(var);
+        seen_use_.insert(var);
+      }
+    }
+
+    void VisitStmt_(const BufferStoreNode *op) final {
+      value.erase(op->buffer->data.get());
+      seen_use_.insert(op->buffer->data.get());
+      StmtExprVisitor::VisitStmt_(op);
+    }
+
+    void VisitExpr_(const BufferLoadNode *op) final {
+      seen_use_.insert(op->buffer->data.get());
+      StmtExprVisitor::VisitExpr_(op);
+    }
+
+    void VisitExpr_(const VarNode *op) final { seen_use_.insert(op); }
+
+    void VisitStmt_(const BlockNode *op) final {
+      for (const Buffer &buf : op->alloc_buffers)
+        alloc_depth_[buf->data.get()] = nest_depth_;
+      StmtExprVisitor::VisitStmt_(op);
+    }
+    void VisitStmt_(const AllocateNode *op) final {
+      alloc_depth_[op->buffer_var.get()] = nest_depth_;
+      StmtExprVisitor::VisitStmt_(op);
+    }
+
+    // a fill in here does not run on every path to the later uses
+    void VisitStmt_(const IfThenElseNode *op) final {
+      ++nest_depth_;
+      StmtExprVisitor::VisitStmt_(op);
+      --nest_depth_;
+    }
+    void VisitStmt_(const ForNode *op) final {
+      ++nest_depth_;
+      StmtExprVisitor::VisitStmt_(op);
+      --nest_depth_;
+    }
+    void VisitStmt_(const WhileNode *op) final {
+      ++nest_depth_;
+      StmtExprVisitor::VisitStmt_(op);
+      --nest_depth_;
+    }
+
+    std::unordered_set<const VarNode *> seen_use_;
+    // if/loop nesting at the allocation of every local buffer
+    std::unordered_map<const VarNode *, int> alloc_depth_;
+    int nest_depth_ = 0;
+  };
+
+  bool IsSameShape(const VarNode *a, const VarNode *b) {
+    auto ia = uses_.buffers.find(a), ib = uses_.buffers.find(b);
+    if (ia == uses_.buffers.end() || ib == uses_.buffers.end())
+      return false;
+    return ia->second->dtype == ib->second->dtype &&
+           StructuralEqual()(ia->second->shape, ib->second->shape);
+  }
+
+  // Fold a binary op whose src1 (or commutative src0) is a constant-filled
+  // buffer into the matching _C instruction.
+  Optional<Stmt> FoldConstOperand(const CallNode *call,
+                                  const std::string &name) {
+    if (name != "ppl.add" && name != "ppl.sub" && name != "ppl.mul" &&
+        name != "ppl.div")
+      return NullOpt;
+    int const_idx = -1;
+    if (const VarNode *v = PtrVar(call->args[3]); v && const_fills_.count(v))
+      const_idx = 3;
+    else if (const VarNode *v = PtrVar(call->args[2]);
+             v && const_fills_.count(v) &&
+             (name == "ppl.add" || name == "ppl.mul"))
+      const_idx = 2;
+    if (const_idx == -1)
+      return NullOpt;
+    FloatImm c = const_fills_.at(PtrVar(call->args[const_idx]));
+    PrimExpr src = call->args[const_idx == 3 ? 2 : 3];
+    double value = c->value;
+    std::string new_name;
+    if (name == "ppl.add") {
+      new_name = "ppl.add_C";
+    } else if (name == "ppl.sub") {
+      new_name = "ppl.add_C";
+      value = -value;
+    } else if (name == "ppl.mul") {
+      new_name = "ppl.mul_C";
+    } else {
+      if (value == 0.0)
+        return NullOpt;
+      new_name = "ppl.mul_C";
+      value = 1.0 / value;
+    }
+    return MakePPLCall(call, new_name,
+                       {call->args[1], src, FloatImm(c->dtype, value)});
+  }
+
+  // Try to fuse two consecutive ops, returning the replacement sequence.
+  Optional<Array<Stmt>> FusePair(const Stmt &s1, const Stmt &s2) {
+    std::string n1, n2;
+    const CallNode *c1 = AsPPLCall(s1, &n1);
+    const CallNode *c2 = AsPPLCall(s2, &n2);
+    if (!c1 || !c2)
+      return NullOpt;
+    auto i1 = ElementwiseTable().find(n1), i2 = ElementwiseTable().find(n2);
+    if (i1 == ElementwiseTable().end() || i2 == ElementwiseTable().end())
+      return NullOpt;
+    const VarNode *t = PtrVar(c1->args[i1->second.dst]);
+    const VarNode *y = PtrVar(c2->args[i2->second.dst]);
+    if (!t || !y || PtrVar(c2->args[2]) != t)
+      return NullOpt;
+    // t must not be read twice by op2 (e.g. mul(y, t, t) stays as is)
+    for (int idx : i2->second.srcs) {
+      if (idx != 2 && PtrVar(c2->args[idx]) == t)
+        return NullOpt;
+    }
+    bool t_dead = uses_.count[t] == CountInStmt(s1, t) + CountInStmt(s2, t);
+    if (y != t && !t_dead)
+      return NullOpt;
+
+    // scalar chains collapse into a single instruction
+    if (n1 == n2 && i1->second.scalar != -1) {
+      const auto *a = c1->args[3].as<FloatImmNode>();
+      const auto *b = c2->args[3].as<FloatImmNode>();
+      if (a && b && a->dtype == b->dtype) {
+        double v = n1 == "ppl.mul_C" ? a->value * b->value : a->value + b->value;
+        changed = true;
+        return Array<Stmt>{MakePPLCall(
+            c1, n1, {c2->args[1], c1->args[2], FloatImm(a->dtype, v)})};
+      }
+    }
+    if (y == t || !IsSameShape(t, y) ||
+        !IsWholeBuffer(c1->args[i1->second.dst]) ||
+        !IsWholeBuffer(c2->args[2]) || !IsWholeBuffer(c2->args[1]))
+      return NullOpt;
+    // op1 would clobber y before op2 reads it
+    for (int idx : i2->second.srcs) {
+      if (PtrVar(c2->args[idx]) == y)
+        return NullOpt;
+    }
+    Buffer y_buf = uses_.buffers.at(y);
+    Array<PrimExpr> a1 = Operands(c1);
+    a1.Set(i1->second.dst - 1, RetargetPtr(c1->args[i1->second.dst], y_buf));
+    Array<PrimExpr> a2 = Operands(c2);
+    a2.Set(1, RetargetPtr(c2->args[2], y_buf));
+    changed = true;
+    return Array<Stmt>{MakePPLCall(c1, n1, a1), MakePPLCall(c2, n2, a2)};
+  }
+
+  Stmt VisitStmt_(const EvaluateNode *op) final {
+    std::string name;
+    if (const CallNode *call = AsPPLCall(GetRef<Stmt>(op), &name)) {
+      if (auto folded = FoldConstOperand(call, name)) {
+        changed = true;
+        return folded.value();
+      }
+    }
+    return GetRef<Stmt>(op);
+  }
+
+  Stmt VisitStmt_(const SeqStmtNode *op) final {
+    Array<Stmt> seq;
+    for (const Stmt &stmt : op->seq) {
+      seq.push_back(VisitStmt(stmt));
+    }
+    Array<Stmt> result;
+    for (size_t i = 0; i < seq.size(); ++i) {
+      if (i + 1 < seq.size()) {
+        if (auto fused = FusePair(seq[i], seq[i + 1])) {
+          for (const Stmt &s : fused.value())
+            result.push_back(s);
+          ++i;
+          continue;
+        }
+      }
+      result.push_back(seq[i]);
+    }
+    return SeqStmt::Flatten(result);
+  }
+
+  BufferUseCounter uses_;
+  std::unordered_map<const VarNode *, FloatImm> const_fills_;
+};
+
+/*!
+ * \brief Point the scratch operands of every ppl.exp at one buffer per class.
+ */
+class ExpScratchSharer : public StmtExprMutator {
+public:
+  static Stmt Rewrite(const Stmt &body) {
+    BufferUseCounter uses;
+    uses(body);
+    ExpScratchSharer sharer;
+    sharer.Collect(body, uses);
+    return sharer(body);
+  }
+
+private:
+  void Collect(const Stmt &body, BufferUseCounter &uses) {
+    // candidates: buffers referenced only from exp scratch slots
+    std::unordered_map<const VarNode *, int> scratch_refs;
+    std::unordered_map<const VarNode *, std::string> klass;
+    std::unordered_set<const VarNode *> mixed;
+    PostOrderVisit(body, [&](const ObjectRef &node) {
+      const auto *eval = node.as<EvaluateNode>();
+      std::string name;
+      const CallNode *call =
+          eval ? AsPPLCall(GetRef<Stmt>(eval), &name) : nullptr;
+      if (!call || name != "ppl.exp")
+        return;
+      for (const auto &[idx, cls] : ExpScratchOperands()) {
+        const VarNode *var = PtrVar(call->args[idx]);
+        if (!var)
+          continue;
+        ++scratch_refs[var];
+        if (klass.count(var) && klass[var] != cls)
+          mixed.insert(var);
+        klass[var] = cls;
+      }
+    });
+    // group by (class, dtype, allocating block) and pick the largest
+    std::map<std::tuple<std::string, std::string, const BlockNode *>,
+             std::vector<const VarNode *>>
+        groups;
+    for (const auto &[var, refs] : scratch_refs) {
+      if (mixed.count(var) || !uses.buffers.count(var) ||
+          uses.count[var] != refs)
+        continue;
+      const Buffer &buf = uses.buffers.at(var);
+      groups[{klass[var], runtime::DLDataType2String(buf->dtype),
+              uses.owner[var]}]
+          .push_back(var);
+    }
+    for (auto &[key, vars] : groups) {
+      if (vars.size() < 2)
+        continue;
+      auto elems = [&](const VarNode *v) {
+        int64_t n = 1;
+        for (const PrimExpr &s : uses.buffers.at(v)->shape) {
+          const auto *imm = s.as<IntImmNode>();
+          n *= imm ? imm->value : std::numeric_limits<int32_t>::max();
+        }
+        return n;
+      };
+      const VarNode *largest = *std::max_element(
+          vars.begin(), vars.end(), [&](const VarNode *a, const VarNode *b) {
+            return elems(a) < elems(b);
+          });
+      for (const VarNode *v : vars) {
+        if (v != largest)
+          remap_[v] = uses.buffers.at(largest);
+      }
+    }
+  }
+
+  PrimExpr VisitExpr_(const CallNode *op) final {
+    if (op->op.same_as(builtin::tvm_access_ptr())) {
+      const VarNode *var = op->args[1].as<VarNode>();
+      auto it = var ? remap_.find(var) : remap_.end();
+      if (it != remap_.end())
+        return RetargetPtr(GetRef<PrimExpr>(op), it->second);
+    }
+    return StmtExprMutator::VisitExpr_(op);
+  }
+
+  std::unordered_map<const VarNode *, Buffer> remap_;
+};
+
+/*!
+ * \brief Drop block allocations that are no longer referenced, together with
+ * the ppl.fill of buffers nobody reads any more.
+ */
+class UnusedBufferRemover : public StmtExprMutator {
+public:
+  static Stmt Rewrite(const Stmt &body) {
+    UnusedBufferRemover remover;
+    remover.uses_(body);
+    PostOrderVisit(body, [&](const ObjectRef &node) {
+      const auto *eval = node.as<EvaluateNode>();
+      std::string name;
+      const CallNode *call =
+          eval ? AsPPLCall(GetRef<Stmt>(eval), &name) : nullptr;
+      if (call && name == "ppl.fill") {
+        if (const VarNode *var = PtrVar(call->args[1]))
+          ++remover.fill_count_[var];
+      }
+    });
+    return remover(body);
+  }
+
+private:
+  bool Unused(const Buffer &buf) {
+    const VarNode *var = buf->data.get();
+    auto it = uses_.count.find(var);
+    return it == uses_.count.end() || it->second == fill_count_[var];
+  }
+
+  Stmt VisitStmt_(const EvaluateNode *op) final {
+    std::string name;
+    const CallNode *call = AsPPLCall(GetRef<Stmt>(op), &name);
+    if (call && name == "ppl.fill") {
+      const VarNode *var = PtrVar(call->args[1]);
+      if (var && uses_.buffers.count(var) && Unused(uses_.buffers.at(var)))
+        return Evaluate(0);
+    }
+    return GetRef<Stmt>(op);
+  }
+
+  Stmt VisitStmt_(const BlockNode *op) final {
+    Block block = Downcast<Block>(StmtExprMutator::VisitStmt_(op));
+    Array<Buffer> alloc;
+    for (const Buffer &buf : block->alloc_buffers) {
+      if (!Unused(buf))
+        alloc.push_back(buf);
+    }
+    if (alloc.size() == block->alloc_buffers.size())
+      return block;
+    auto keep = [this](const Array<BufferRegion> &regions) {
+      Array<BufferRegion> result;
+      for (const BufferRegion &r : regions) {
+        if (!Unused(r->buffer))
+          result.push_back(r);
+      }
+      return result;
+    };
+    BlockNode *n = block.CopyOnWrite();
+    n->alloc_buffers = alloc;
+    n->reads = keep(n->reads);
+    n->writes = keep(n->writes);
+    return block;
+  }
+
+  BufferUseCounter uses_;
+  std::unordered_map<const VarNode *, int> fill_count_;
+};
+
+} // namespace
+
+PrimFunc FusePPLElementwiseChains(PrimFunc f) {
+  // every round fuses one pair per position, chains need a few rounds
+  for (int round = 0; round < 8; ++round) {
+    PPLElementwiseFuser fuser(f->body);
+    Stmt body = fuser(f->body);
+    if (!fuser.changed)
+      break;
+    f.CopyOnWrite()->body = body;
+  }
+  f.CopyOnWrite()->body = ExpScratchSharer::Rewrite(f->body);
+  f.CopyOnWrite()->body = UnusedBufferRemover::Rewrite(f->body);
+  return f;
+}
+
+using namespace tir::transform;
+tvm::transform::Pass FusePPLElementwise() {
+  auto pass_func = [=](PrimFunc f, IRModule m, PassContext ctx) {
+    return FusePPLElementwiseChains(std::move(f));
+  };
+  return CreatePrimFuncPass(pass_func, 0, "tl.FusePPLElementwise", {});
+}
+
+TVM_REGISTER_GLOBAL("tl.transform.FusePPLElementwise")
+    .set_body_typed(FusePPLElementwise);
+
+} // namespace tl
+} // namespace tvm
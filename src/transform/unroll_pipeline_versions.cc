@@ -0,0 +1,211 @@
+// Copyright (c) Tile-AI Corporation.
+// Licensed under the MIT License.
+/*!
+ * \file unroll_pipeline_versions.cc
+ * \brief Unroll pipelined loops by their buffer version count.
+ *
+ * InjectSoftwarePipeline materialises every multi-versioned buffer as N
+ * sibling buffers (`A_shared_0 .. A_shared_{N-1}`) and selects the one used by
+ * an iteration with
+ *
+ *   A_shared = if_then_else(floormod(k - min, N) == 0, A_shared_0.data, ...)
+ *
+ * On TPU the selection is evaluated by the scalar core in every iteration.
+ * This pass unrolls such loops by N (the lcm if several version counts
+ * appear), so that after Simplify every copy of the body refers to a fixed
+ * version and the selection disappears. A constant remainder is peeled into
+ * straight-line code; a symbolic one keeps a short tail loop.
+ *
+ * The versions of every selection are recorded in the `tl.pipeline_versions`
+ * function attr, which AddressAssign reads to place them in distinct banks.
+ */
+
+#include <tvm/arith/analyzer.h>
+#include <tvm/tir/analysis.h>
+#include <tvm/tir/builtin.h>
+#include <tvm/tir/op.h>
+#include <tvm/tir/stmt_functor.h>
+#include <tvm/tir/transform.h>
+
+#include <numeric>
+#include <string>
+#include <unordered_set>
+
+#include "../op/builtin.h"
+
+namespace tvm {
+namespace tl {
+
+using namespace tir;
+
+// Unrolling beyond this factor costs more code than the branch it removes.
+static constexpr int kMaxVersionUnroll = 8;
+
+/*!
+ * \brief Collect the version counts N of `if_then_else(floormod(e, N) == c,
+ * buf_c, ...)` selections that depend on \p loop_var.
+ */
+class VersionSelectCollector : public StmtExprVisitor {
+public:
+  explicit VersionSelectCollector(const Var &loop_var) : loop_var_(loop_var) {}
+
+  int factor = 1;
+
+private:
+  void VisitExpr_(const CallNode *op) final {
+    if (op->op.same_as(builtin::if_then_else())) {
+      if (const auto *eq = op->args[0].as<EQNode>()) {
+        const auto *mod = eq->a.as<FloorModNode>();
+        const auto *n = mod ? mod->b.as<IntImmNode>() : nullptr;
+        if (n && n->value > 1 && UsesVar(mod->a, [this](const VarNode *v) {
+              return v == loop_var_.get();
+            })) {
+          factor = std::lcm(factor, static_cast<int>(n->value));
+        }
+      }
+    }
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  const Var &loop_var_;
+};
+
+/*!
+ * \brief Collect the buffer data vars of every `if_then_else(floormod(e, N) ==
+ * c, buf_0, if_then_else(..., buf_1, ...))` selection chain as one group.
+ */
+class VersionGroupCollector : public StmtExprVisitor {
+public:
+  Array<Array<String>> groups;
+
+private:
+  static bool IsVersionSelect(const CallNode *op) {
+    if (!op->op.same_as(builtin::if_then_else())) {
+      return false;
+    }
+    const auto *eq = op->args[0].as<EQNode>();
+    const auto *mod = eq ? eq->a.as<FloorModNode>() : nullptr;
+    return mod && mod->b.as<IntImmNode>();
+  }
+
+  void VisitExpr_(const CallNode *op) final {
+    if (!IsVersionSelect(op)) {
+      StmtExprVisitor::VisitExpr_(op);
+      return;
+    }
+    Array<String> group;
+    const CallNode *select = op;
+    while (true) {
+      VisitExpr(select->args[0]);
+      if (const auto *v = select->args[1].as<VarNode>()) {
+        group.push_back(v->name_hint);
+      }
+      const auto *next = select->args[2].as<CallNode>();
+      if (!next || !IsVersionSelect(next)) {
+        if (const auto *v = select->args[2].as<VarNode>()) {
+          group.push_back(v->name_hint);
+        }
+        break;
+      }
+      select = next;
+    }
+    if (group.size() > 1 && seen_.insert(Join(group)).second) {
+      groups.push_back(group);
+    }
+  }
+
+  static std::string Join(const Array<String> &names) {
+    std::string key;
+    for (const auto &name : names) {
+      key += std::string(name) + ",";
+    }
+    return key;
+  }
+
+  std::unordered_set<std::string> seen_;
+};
+
+class PipelineVersionUnroller : public StmtExprMutator {
+public:
+  static PrimFunc Substitute(PrimFunc &f) {
+    VersionGroupCollector groups;
+    groups(f->body);
+    auto rewriter = PipelineVersionUnroller();
+    f.CopyOnWrite()->body = rewriter(f->body);
+    if (!groups.groups.empty()) {
+      f = WithAttr(std::move(f), kPipelineVersions, groups.groups);
+    }
+    return f;
+  }
+
+private:
+  PipelineVersionUnroller() = default;
+
+  Stmt CopyBody(const For &loop, PrimExpr index) {
+    return tir::Substitute(loop->body, {{loop->loop_var, loop->min + index}});
+  }
+
+  Stmt VisitStmt_(const ForNode *op) final {
+    For loop = Downcast<For>(StmtExprMutator::VisitStmt_(op));
+    if (loop->kind != ForKind::kSerial) {
+      return loop;
+    }
+    VersionSelectCollector collector(loop->loop_var);
+    collector(loop->body);
+    int factor = collector.factor;
+    if (factor <= 1 || factor > kMaxVersionUnroll) {
+      return loop;
+    }
+    const auto *const_extent = loop->extent.as<IntImmNode>();
+    if (const_extent && const_extent->value < factor) {
+      Array<Stmt> seq;
+      for (int j = 0; j < const_extent->value; ++j) {
+        seq.push_back(CopyBody(loop, make_const(loop->loop_var.dtype(), j)));
+      }
+      return seq.empty() ? Evaluate(0) : SeqStmt::Flatten(seq);
+    }
+
+    DataType dtype = loop->loop_var.dtype();
+    PrimExpr n = make_const(dtype, factor);
+    Var outer = loop->loop_var.copy_with_suffix("_o");
+    Array<Stmt> unrolled;
+    for (int j = 0; j < factor; ++j) {
+      unrolled.push_back(CopyBody(loop, outer * n + make_const(dtype, j)));
+    }
+    PrimExpr main_extent = analyzer_.Simplify(floordiv(loop->extent, n));
+    Array<Stmt> result;
+    result.push_back(For(outer, make_zero(dtype), main_extent, ForKind::kSerial,
+                         SeqStmt::Flatten(unrolled), NullOpt,
+                         loop->annotations));
+
+    PrimExpr tail_begin = main_extent * n;
+    if (const_extent) {
+      for (int j = 0; j < const_extent->value % factor; ++j) {
+        result.push_back(
+            CopyBody(loop, analyzer_.Simplify(tail_begin + make_const(dtype, j))));
+      }
+    } else {
+      Var tail = loop->loop_var.copy_with_suffix("_t");
+      result.push_back(For(tail, make_zero(dtype),
+                           floormod(loop->extent, n), ForKind::kSerial,
+                           CopyBody(loop, tail_begin + tail)));
+    }
+    return SeqStmt::Flatten(result);
+  }
+
+  arith::Analyzer analyzer_;
+};
+
+using namespace tir::transform;
+tvm::transform::Pass UnrollPipelineVersions() {
+  auto pass_func = [=](PrimFunc f, IRModule m, PassContext ctx) {
+    return PipelineVersionUnroller::Substitute(f);
+  };
+  return CreatePrimFuncPass(pass_func, 0, "tl.UnrollPipelineVersions", {});
+}
+
+TVM_REGISTER_GLOBAL("tl.transform.UnrollPipelineVersions")
+    .set_body_typed(UnrollPipelineVersions);
+
+} // namespace tl
+} // namespace tvm
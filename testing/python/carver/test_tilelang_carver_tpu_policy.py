@@ -0,0 +1,48 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+import tilelang.testing
+from tilelang import carver
+from tilelang.carver.arch import TPU, get_arch
+
+
+def run_tpu_matmul_recommend_hints(M: int = 1024,
+                                   N: int = 1024,
+                                   K: int = 1024,
+                                   in_dtype: str = "float16",
+                                   out_dtype: str = "float32",
+                                   topk: int = 10):
+    arch = TPU("tpu -chip=bm1690")
+    carve_template = carver.MatmulTemplate(
+        M=M,
+        N=N,
+        K=K,
+        in_dtype=in_dtype,
+        out_dtype=out_dtype,
+        accum_dtype=out_dtype,
+    ).with_arch(arch)
+
+    hints = carve_template.recommend_hints(topk=topk)
+    assert len(hints) > 0, "Hints length is zero"
+    latencies = [hint.estimate.latency_us for hint in hints]
+    assert latencies == sorted(latencies), "Hints are not ranked by the cost model"
+    for hint in hints:
+        est = hint.estimate
+        assert est.banks <= arch.bank_num
+        assert est.local_mem_per_npu <= arch.local_mem_per_npu
+        assert hint.pipeline_stage in (1, 2)
+
+
+def test_tpu_matmul_recommend_hints():
+    run_tpu_matmul_recommend_hints(1024, 1024, 1024)
+    run_tpu_matmul_recommend_hints(4096, 4096, 4096)
+    run_tpu_matmul_recommend_hints(256, 1024, 512, "int8", "int32")
+
+
+def test_tpu_get_arch():
+    arch = get_arch("tpu -chip=bm1684x")
+    assert arch.chip == "bm1684x"
+    assert arch.bank_size * arch.bank_num == arch.local_mem_per_npu
+
+
+if __name__ == "__main__":
+    tilelang.testing.main()
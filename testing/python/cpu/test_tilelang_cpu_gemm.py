@@ -1,6 +1,8 @@
 # Copyright (c) Tile-AI Corporation.
 # Licensed under the MIT License.
 
+import pytest
+
 import tilelang
 import tilelang.testing
 from tilelang import tvm as tvm
@@ -116,5 +118,58 @@ def test_matmul_compile():
     tilelang.testing.torch_assert_close(C, C_torch, atol=1e-2, rtol=1e-2, max_mismatched_ratio=0.05)
 
 
+def matmul_gemm(M, N, K, block_M, block_N, block_K, dtype="float16", accum_dtype="float"):
+
+    @T.prim_func
+    def matmul(
+            A: T.Tensor((M, K), dtype),
+            B: T.Tensor((K, N), dtype),
+            C: T.Tensor((M, N), accum_dtype),
+    ):
+        with T.Kernel(T.ceildiv(N, block_N), T.ceildiv(M, block_M), is_cpu=True) as (bx, by):
+            A_local = T.alloc_local((block_M, block_K), dtype)
+            B_local = T.alloc_local((block_K, block_N), dtype)
+            C_local = T.alloc_local((block_M, block_N), accum_dtype)
+
+            T.clear(C_local)
+            for ko in T.serial(K // block_K):
+                T.copy(A[by * block_M, ko * block_K], A_local)
+                T.copy(B[ko * block_K, bx * block_N], B_local)
+                T.gemm(A_local, B_local, C_local)
+
+            T.copy(C_local, C[by * block_M, bx * block_N])
+
+    return matmul
+
+
+def test_matmul_gemm_codegen():
+    func = matmul_gemm(256, 256, 256, 64, 64, 32)
+    code = tilelang.lower(func, target="c").kernel_source
+    # the register-blocked template instead of a scalar loop nest
+    assert "tl::cpu::gemm_ss<64, 64, 32, 0, 0, 0>" in code
+
+
+def test_matmul_gemm_rejected_on_devices():
+    func = matmul_gemm(256, 256, 256, 64, 64, 32)
+    # the tpu and rvv backends lower with a dummy llvm target, T.gemm must not
+    # become the host template there
+    for target in ("tpu", "rvv"):
+        with pytest.raises(ValueError, match="T.gemm is not supported"):
+            tilelang.lower(func, target=target)
+
+
+def test_matmul_gemm_compile():
+    M, N, K = 256, 192, 128
+    func = matmul_gemm(M, N, K, 64, 64, 32)
+    kernel = tilelang.compile(func, -1, execution_backend="ctypes", target="c")
+
+    A = torch.randn(M, K, dtype=torch.float16)
+    B = torch.randn(K, N, dtype=torch.float16)
+    C = kernel(A, B)
+    C_torch = torch.matmul(A.float(), B.float())
+
+    tilelang.testing.torch_assert_close(C, C_torch, atol=1e-2, rtol=1e-2)
+
+
 if __name__ == "__main__":
     tilelang.testing.main()
@@ -0,0 +1,393 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+
+import functools
+
+import numpy as np
+import pytest
+
+import tilelang
+import tilelang.testing
+import tilelang.language as T
+from tilelang.contrib import rvv
+from tilelang import tvm as tvm
+
+requires_qemu = pytest.mark.skipif(
+    rvv.get_rvv_cc() is None or rvv.get_qemu() is None,
+    reason="riscv64 cross compiler or qemu-riscv64 not found")
+
+
+def scale(M, N, value, dtype="float32"):
+
+    @T.prim_func
+    def main(
+            X: T.Tensor((M, N), dtype),
+            Y: T.Tensor((M, N), dtype),
+    ):
+        with T.Kernel(1, 1, is_cpu=True) as (bx, by):
+            X_shared = T.alloc_shared((M, N), dtype)
+            Y_shared = T.alloc_shared((M, N), dtype)
+            T.rvv_copy(X[0, 0], X_shared)
+            T.rvv_mul_C(Y_shared, X_shared, T.float32(value))
+            T.rvv_copy(Y_shared, Y[0, 0])
+
+    return main
+
+
+def test_rvv_no_main_guard():
+    artifact = tilelang.lower(scale(4, 64, 2.0), target="rvv")
+    # the smoke-test main must be excluded when a driver is linked in
+    assert "#ifndef TILELANG_RVV_NO_MAIN" in artifact.kernel_source
+
+
+def test_rvv_lmul_adaptive():
+    # a long elementwise loop keeps two vectors live and takes whole m8 groups
+    code = tilelang.lower(scale(4, 64, 2.0), target="rvv").kernel_source
+    assert "__riscv_vfmul_vf_f32m8(" in code
+    # 8 elements need an m2 group at VLEN 128 but one register at VLEN 256
+    code = tilelang.lower(scale(1, 8, 2.0), target="rvv").kernel_source
+    assert "__riscv_vfmul_vf_f32m2(" in code
+    code = tilelang.lower(scale(1, 8, 2.0), target="rvv -vlen=256").kernel_source
+    assert "__riscv_vfmul_vf_f32m1(" in code
+
+
+@requires_qemu
+@pytest.mark.parametrize("vlen", [128, 256, 512])
+def test_rvv_scale_qemu(vlen):
+    M, N = 4, 100
+    artifact = tilelang.lower(scale(M, N, 2.0), target="rvv")
+    x = np.random.rand(M, N).astype(np.float32)
+    y = np.zeros((M, N), dtype=np.float32)
+    result = rvv.run_rvv_kernel(artifact, [x, y], vlen=vlen)
+    np.testing.assert_allclose(result.outputs[1], x * 2.0, rtol=1e-6)
+    # inputs are written back too
+    np.testing.assert_array_equal(result.outputs[0], x)
+
+
+@pytest.mark.skipif(
+    rvv.get_native_cc() is None and (rvv.get_rvv_cc() is None or rvv.get_qemu() is None),
+    reason="neither a riscv64 host nor a cross compiler and qemu-riscv64")
+def test_rvv_adapter():
+    import torch
+    from tilelang.jit.adapter.rvv import RVVKernelAdapter
+
+    M, N = 4, 100
+    artifact = tilelang.lower(scale(M, N, 2.0), target="rvv")
+    # natively the second call reuses the cached shared object
+    kernel = RVVKernelAdapter(artifact, [-1])
+    for _ in range(2):
+        x = torch.rand(M, N)
+        torch.testing.assert_close(kernel(x), x * 2.0)
+
+
+def tiled_scale(M, N, block_M, block_N, value, dtype="float32"):
+
+    @T.prim_func
+    def main(
+            X: T.Tensor((M, N), dtype),
+            Y: T.Tensor((M, N), dtype),
+    ):
+        with T.Kernel(M // block_M, N // block_N, is_cpu=True) as (bx, by):
+            X_shared = T.alloc_shared((block_M, block_N), dtype)
+            Y_shared = T.alloc_shared((block_M, block_N), dtype)
+            T.rvv_copy(X[bx * block_M, by * block_N], X_shared)
+            T.rvv_mul_C(Y_shared, X_shared, T.float32(value))
+            T.rvv_copy(Y_shared, Y[bx * block_M, by * block_N])
+
+    return main
+
+
+def test_rvv_multi_hart_grid():
+    code = tilelang.lower(tiled_scale(64, 64, 16, 32, 2.0), target="rvv").kernel_source
+    assert "#pragma omp parallel for schedule(static) collapse(2)" in code
+    code = tilelang.lower(
+        tiled_scale(64, 64, 16, 32, 2.0), target="rvv -threads=4 -schedule=dynamic").kernel_source
+    assert "schedule(dynamic, 1) collapse(2) num_threads(4)" in code
+    # a single block, or a serial build, has nothing to spread
+    code = tilelang.lower(scale(4, 64, 2.0), target="rvv").kernel_source
+    assert "#pragma omp" not in code
+    code = tilelang.lower(tiled_scale(64, 64, 16, 32, 2.0), target="rvv -threads=1").kernel_source
+    assert "#pragma omp" not in code
+
+
+@requires_qemu
+@pytest.mark.parametrize("schedule", ["static", "dynamic"])
+def test_rvv_multi_hart_qemu(schedule):
+    M, N = 64, 64
+    artifact = tilelang.lower(
+        tiled_scale(M, N, 16, 32, 2.0), target=f"rvv -threads=4 -schedule={schedule}")
+    x = np.random.rand(M, N).astype(np.float32)
+    y = np.zeros((M, N), dtype=np.float32)
+    result = rvv.run_rvv_kernel(artifact, [x, y])
+    np.testing.assert_allclose(result.outputs[1], x * 2.0, rtol=1e-6)
+
+
+def gemm(M, N, K, trans_B, dtype="float32", accum_dtype="float32"):
+    B_shape = (N, K) if trans_B else (K, N)
+
+    @T.prim_func
+    def main(
+            A: T.Tensor((M, K), dtype),
+            B: T.Tensor(B_shape, dtype),
+            C: T.Tensor((M, N), accum_dtype),
+    ):
+        with T.Kernel(1, 1, is_cpu=True) as (bx, by):
+            A_shared = T.alloc_shared((M, K), dtype)
+            B_shared = T.alloc_shared(B_shape, dtype)
+            C_shared = T.alloc_shared((M, N), accum_dtype)
+            T.rvv_copy(A[0, 0], A_shared)
+            T.rvv_copy(B[0, 0], B_shared)
+            T.rvv_fill(C_shared, T.float32(0) if "float" in accum_dtype else T.int32(0))
+            T.rvv_gemm(A_shared, B_shared, C_shared, transpose_B=trans_B)
+            T.rvv_copy(C_shared, C[0, 0])
+
+    return main
+
+
+def test_rvv_gemm_register_tile():
+    code = tilelang.lower(gemm(16, 64, 32, False), target="rvv").kernel_source
+    # C stays in registers over K: one scalar-vector FMA per accumulator
+    assert "__riscv_vfmacc_vf_f32m" in code
+    # B is packed into a per-hart scratch of K * N elements, not a malloc per call
+    assert "static _Thread_local float bpack[2048];" in code
+    # a single row block streams B in place
+    code = tilelang.lower(gemm(1, 64, 32, False), target="rvv").kernel_source
+    assert "bpack" not in code
+    # 1024 x 512 floats would take 2 MiB of static scratch per hart
+    with pytest.raises(tvm.TVMError, match="byte limit"):
+        tilelang.lower(gemm(16, 1024, 512, False), target="rvv")
+
+
+def test_rvv_gemm_widening_mac():
+    # fp16 and int8 multiply at half the accumulator width and widen in the MAC
+    code = tilelang.lower(gemm(16, 64, 32, False, "float16"), target="rvv").kernel_source
+    assert "__riscv_vfwmacc_vf_f32m" in code
+    code = tilelang.lower(gemm(16, 64, 32, False, "int8", "int32"), target="rvv").kernel_source
+    assert "__riscv_vwmacc_vx_i32m" in code
+    assert "__riscv_vsext_vf4" not in code
+
+
+@requires_qemu
+@pytest.mark.parametrize("trans_B", [False, True])
+@pytest.mark.parametrize("vlen", [128, 256])
+def test_rvv_gemm_qemu(trans_B, vlen):
+    # odd sizes exercise the row and column tails of the micro-kernel
+    M, N, K = 13, 37, 19
+    artifact = tilelang.lower(gemm(M, N, K, trans_B), target="rvv")
+    a = np.random.rand(M, K).astype(np.float32)
+    b = np.random.rand(N, K).astype(np.float32) if trans_B else np.random.rand(K, N).astype(
+        np.float32)
+    c = np.zeros((M, N), dtype=np.float32)
+    result = rvv.run_rvv_kernel(artifact, [a, b, c], vlen=vlen)
+    ref = a @ (b.T if trans_B else b)
+    np.testing.assert_allclose(result.outputs[2], ref, rtol=1e-4, atol=1e-4)
+
+
+def unary(M, N, op, dtype="float32"):
+
+    @T.prim_func
+    def main(
+            X: T.Tensor((M, N), dtype),
+            Y: T.Tensor((M, N), dtype),
+    ):
+        with T.Kernel(1, 1, is_cpu=True) as (bx, by):
+            X_shared = T.alloc_shared((M, N), dtype)
+            Y_shared = T.alloc_shared((M, N), dtype)
+            T.rvv_copy(X[0, 0], X_shared)
+            op(Y_shared, X_shared)
+            T.rvv_copy(Y_shared, Y[0, 0])
+
+    return main
+
+
+def _gelu(x):
+    u = np.sqrt(2 / np.pi) * (x + 0.044715 * x**3)
+    return 0.5 * x * (1 + np.tanh(u))
+
+
+UNARY_OPS = [
+    (T.rvv_exp, np.exp, "exp"),
+    (T.rvv_exp_base2, np.exp2, "exp2"),
+    (T.rvv_log, np.log, "log"),
+    (T.rvv_tanh, np.tanh, "tanh"),
+    (T.rvv_sigmoid, lambda x: 1 / (1 + np.exp(-x)), "sigmoid"),
+    (T.rvv_gelu, _gelu, "gelu"),
+]
+
+
+def test_rvv_unary_vectorised():
+    code = tilelang.lower(unary(4, 64, T.rvv_exp), target="rvv").kernel_source
+    assert "tl_rvv_exp_f32m4(" in code
+    # no scalar libm round trip
+    assert "expf(" not in code
+
+
+def test_rvv_exp2_legacy_is_natural_exp():
+
+    def legacy(out, inp):
+        # in place on out, inp only stands in for the unused work buffers
+        T.rvv_exp2(out, inp, inp, inp, inp)
+
+    with pytest.warns(DeprecationWarning):
+        code = tilelang.lower(unary(4, 64, legacy), target="rvv").kernel_source
+    assert "tl_rvv_exp_f32m4(" in code
+    assert "tl_rvv_exp2_f32m" not in code
+
+
+@requires_qemu
+@pytest.mark.parametrize("op,ref,name", UNARY_OPS, ids=[op[2] for op in UNARY_OPS])
+def test_rvv_unary_qemu(op, ref, name):
+    M, N = 4, 100
+    artifact = tilelang.lower(unary(M, N, op), target="rvv")
+    # log is only defined for positive inputs
+    low = 1e-3 if name == "log" else -8
+    x = np.random.uniform(low, 8, (M, N)).astype(np.float32)
+    y = np.zeros((M, N), dtype=np.float32)
+    result = rvv.run_rvv_kernel(artifact, [x, y])
+    np.testing.assert_allclose(result.outputs[1], ref(x), rtol=1e-5, atol=1e-6)
+
+
+
+def chain(M, N, dtype="float32"):
+
+    @T.prim_func
+    def main(
+            X: T.Tensor((M, N), dtype),
+            S: T.Tensor((M, 1), dtype),
+            Y: T.Tensor((M, N), dtype),
+    ):
+        with T.Kernel(1, 1, is_cpu=True) as (bx, by):
+            X_shared = T.alloc_shared((M, N), dtype)
+            S_shared = T.alloc_shared((M, 1), dtype)
+            Y_shared = T.alloc_shared((M, N), dtype)
+            T.rvv_copy(X[0, 0], X_shared)
+            T.rvv_copy(S[0, 0], S_shared)
+            T.rvv_mul_C(Y_shared, X_shared, T.float32(0.5))
+            T.rvv_subtract(Y_shared, Y_shared, S_shared)
+            T.rvv_exp(Y_shared, Y_shared)
+            T.rvv_add_C(Y_shared, Y_shared, T.float32(1.0))
+            T.rvv_mul(Y_shared, Y_shared, S_shared)
+            T.rvv_copy(Y_shared, Y[0, 0])
+
+    return main
+
+
+def test_rvv_elementwise_fused():
+    code = tilelang.lower(chain(4, 64), target="rvv").kernel_source
+    # one loop for the whole chain, each tile loaded and stored once per strip
+    assert "// rvv.mul_C rvv.sub rvv.exp rvv.add_C rvv.mul\n" in code
+    assert code.count("tl_rvv_exp_f32m") == 1
+    # only the copy into Y publishes to global memory
+    assert code.count("fence ow, ow") == 1
+
+
+@requires_qemu
+def test_rvv_elementwise_fused_qemu():
+    M, N = 4, 100
+    artifact = tilelang.lower(chain(M, N), target="rvv")
+    x = np.random.uniform(-4, 4, (M, N)).astype(np.float32)
+    s = np.random.uniform(0.5, 2, (M, 1)).astype(np.float32)
+    y = np.zeros((M, N), dtype=np.float32)
+    result = rvv.run_rvv_kernel(artifact, [x, s, y])
+    np.testing.assert_allclose(result.outputs[2], (np.exp(x * 0.5 - s) + 1) * s, rtol=1e-5)
+
+
+def reduce(M, N, op, dim, dtype="float32", ordered=False):
+    out_shape = (M, 1) if dim == 1 else (1, N)
+    if op == "max":
+        reducer = T.rvv_reduce_max
+    else:
+        reducer = functools.partial(T.rvv_reduce_sum, ordered=ordered)
+
+    @T.prim_func
+    def main(
+            X: T.Tensor((M, N), dtype),
+            Y: T.Tensor(out_shape, dtype),
+    ):
+        with T.Kernel(1, 1, is_cpu=True) as (bx, by):
+            X_shared = T.alloc_shared((M, N), dtype)
+            Y_shared = T.alloc_shared(out_shape, dtype)
+            T.rvv_copy(X[0, 0], X_shared)
+            reducer(X_shared, Y_shared, dim)
+            T.rvv_copy(Y_shared, Y[0, 0])
+
+    return main
+
+
+def test_rvv_reduce_tree():
+    code = tilelang.lower(reduce(8, 100, "max", 1), target="rvv").kernel_source
+    # four rows in flight fold into wide accumulators, one vfredmax per row
+    assert code.count("__riscv_vfmax_vv_f32m4_tu(") == 4
+    assert code.count("__riscv_vfredmax_vs_f32m4_f32m1(") == 4
+    assert "(float)(-INFINITY)" in code
+    code = tilelang.lower(reduce(8, 100, "max", 1, "int32"), target="rvv").kernel_source
+    assert "INT32_MIN" in code and "numeric_limits" not in code
+    code = tilelang.lower(reduce(8, 100, "sum", 1, ordered=True), target="rvv").kernel_source
+    assert "__riscv_vfredosum_vs_f32m4_f32m1(" in code
+    # across the rows there is nothing left to reduce within a vector
+    code = tilelang.lower(reduce(8, 100, "sum", 0), target="rvv").kernel_source
+    assert "__riscv_vfadd_vv_f32m8(" in code and "vfred" not in code
+
+
+@requires_qemu
+@pytest.mark.parametrize("op", ["max", "sum"])
+@pytest.mark.parametrize("dim", [0, 1])
+@pytest.mark.parametrize("dtype", ["float32", "int32"])
+def test_rvv_reduce_qemu(op, dim, dtype):
+    M, N = 7, 37
+    artifact = tilelang.lower(reduce(M, N, op, dim, dtype), target="rvv")
+    # all negative, so a max starting from 0 would show
+    x = np.random.uniform(-100, -1, (M, N)).astype(dtype)
+    y = np.zeros((M, 1) if dim == 1 else (1, N), dtype=dtype)
+    result = rvv.run_rvv_kernel(artifact, [x, y])
+    ref = (x.max if op == "max" else x.sum)(axis=dim, keepdims=True)
+    np.testing.assert_allclose(result.outputs[1], ref, rtol=1e-5)
+
+
+def cast(M, N, src_dtype, dst_dtype):
+
+    @T.prim_func
+    def main(
+            X: T.Tensor((M, N), src_dtype),
+            Y: T.Tensor((M, N), dst_dtype),
+    ):
+        with T.Kernel(1, 1, is_cpu=True) as (bx, by):
+            X_shared = T.alloc_shared((M, N), src_dtype)
+            Y_shared = T.alloc_shared((M, N), dst_dtype)
+            T.rvv_copy(X[0, 0], X_shared)
+            T.rvv_copy(X_shared, Y_shared)
+            T.rvv_copy(Y_shared, Y[0, 0])
+
+    return main
+
+
+def test_rvv_copy_convert_in_register():
+    code = tilelang.lower(cast(4, 64, "float32", "int8"), target="rvv").kernel_source
+    # narrow to int16 while converting, then saturate to int8
+    assert "__riscv_vfncvt_x_f_w_i16m4(" in code
+    assert "__riscv_vnclip_wx_i8m2(" in code
+    code = tilelang.lower(cast(4, 64, "float32", "float16"), target="rvv").kernel_source
+    assert "__riscv_vfncvt_f_f_w_f16m4(" in code
+    code = tilelang.lower(cast(4, 64, "uint8", "float32"), target="rvv").kernel_source
+    assert "__riscv_vzext_vf2_u16m4(" in code and "__riscv_vfwcvt_f_xu_v_f32m8(" in code
+
+
+@requires_qemu
+@pytest.mark.parametrize("dst_dtype", ["int8", "uint8", "int16", "float16"])
+def test_rvv_copy_convert_qemu(dst_dtype):
+    M, N = 4, 100
+    artifact = tilelang.lower(cast(M, N, "float32", dst_dtype), target="rvv")
+    x = np.random.uniform(-300, 300, (M, N)).astype(np.float32)
+    y = np.zeros((M, N), dtype=dst_dtype)
+    result = rvv.run_rvv_kernel(artifact, [x, y], arch="rv64gcv_zvfh")
+    if dst_dtype == "float16":
+        ref = x.astype(np.float16)
+    else:
+        info = np.iinfo(dst_dtype)
+        # round to nearest even and saturate
+        ref = np.clip(np.rint(x), info.min, info.max).astype(dst_dtype)
+    np.testing.assert_array_equal(result.outputs[1], ref)
+
+
+if __name__ == "__main__":
+    tilelang.testing.main()
@@ -0,0 +1,87 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+
+import tilelang
+import tilelang.testing
+import tilelang.language as T
+
+
+def row_parallel_linear(M, N, K, block_M, block_N, dtype="float16", accum_dtype="float32"):
+
+    @T.prim_func
+    def main(
+            A: T.Tensor((M, K), dtype),
+            B: T.Tensor((K, N), dtype),
+            C: T.Tensor((M, N), accum_dtype),
+    ):
+        with T.Kernel(T.ceildiv(N, block_N), T.ceildiv(M, block_M), is_cpu=True) as (bx, by):
+            A_shared = T.alloc_shared((block_M, K), dtype)
+            B_shared = T.alloc_shared((K, block_N), dtype)
+            C_shared = T.alloc_shared((block_M, block_N), accum_dtype)
+            T.ppl_fill(C_shared, T.float32(0))
+            T.ppl_copy(A[by * block_M, 0], A_shared)
+            T.ppl_copy(B[0, bx * block_N], B_shared)
+            T.ppl_gemm(A_shared, B_shared, C_shared)
+            T.ppl_copy(C_shared, C[by * block_M, bx * block_N])
+            # every chip holds a partial sum over its K shard
+            T.ppl_all_reduce(C[by * block_M:(by + 1) * block_M, bx * block_N:(bx + 1) * block_N])
+
+    return main
+
+
+def gather_scatter(M, N, world, dtype="float32"):
+
+    @T.prim_func
+    def main(
+            X: T.Tensor((M, N), dtype),
+            Full: T.Tensor((M * world, N), dtype),
+            Part: T.Tensor((M, N), dtype),
+    ):
+        with T.Kernel(1, is_cpu=True) as (bx,):
+            T.ppl_all_gather(X, Full)
+            T.ppl_reduce_scatter(Full, Part, op="max")
+
+    return main
+
+
+def test_all_reduce_lowering():
+    source = tilelang.lower(row_parallel_linear(256, 256, 128, 128, 128), target="tpu").kernel_source
+    # one emulated chip goes through the fake CDMA entry point
+    assert "tpu_cdma_fake_all_reduce" in source
+    assert "__ppl_reduce_scatter" in source and "__ppl_all_gather" in source
+    # the all-reduce waits for the CDMA engine only
+    assert "tpu_cdma_poll()" in source
+    # the cores split the columns instead of leaving the work to core 0
+    assert "tpu_core_index() == 0" not in source
+    assert "int col0 = MIN(tpu_core_index() * core_cols, C.shape.w);" in source
+    # each block's tile is reduced in the block body, right after its store:
+    # the block loops run the same way on every core, so all of them reach
+    # both barriers
+    lines = source.splitlines()
+    syncs = [i for i, line in enumerate(lines) if "tpu_sync_core();" in line]
+    store = next(i for i, line in enumerate(lines) if "tpu_gdma_cpy_L2S(" in line)
+    loop = next(i for i, line in enumerate(lines) if line.lstrip().startswith("for ("))
+
+    def indent(line):
+        return len(line) - len(line.lstrip())
+
+    assert len(syncs) == 2 and store < syncs[0]
+    assert all(indent(lines[i]) > indent(lines[loop]) for i in syncs)
+    # the ring works on the block's 128 x 128 tile of C, not on the whole C
+    call = next(line for line in lines if "tpu_cdma_fake_all_reduce(" in line)
+    tile = call.split("tpu_chip_id(), ")[1].split(".addr")[0]
+    decl = next(line for line in lines if f"__ppl_tensor_info {tile} = " in line)
+    assert "{.shape = {1, 128, 1, 128}, " in decl
+
+
+def test_all_gather_reduce_scatter_lowering():
+    source = tilelang.lower(gather_scatter(64, 128, 2), target="tpu").kernel_source
+    assert "tpu_cdma_send" in source and "tpu_cdma_fake_p2p" in source
+    # ALL_REDUCE_MAX
+    assert "__ppl_reduce_scatter(" in source and ", 2, DT_FP32);" in source
+    # two barriers per collective
+    assert source.count("tpu_sync_core();") == 4
+
+
+if __name__ == "__main__":
+    tilelang.testing.main()
@@ -0,0 +1,103 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+
+import tilelang
+import tilelang.testing
+import tilelang.language as T
+
+
+def conv3x3(N, C, H, W, OC, tile_h, tile_w, dtype="float16", out_dtype="float32", requant=False):
+    # every output tile reads a (tile + 2) window of the input: 3x3, stride 1, pad 1
+    in_h, in_w = tile_h + 2, tile_w + 2
+
+    @T.prim_func
+    def main(
+            X: T.Tensor((N, C, H, W), dtype),
+            Wt: T.Tensor((1, C, OC, 9), dtype),
+            Q: T.Tensor((1, OC, 1, 3), "int32"),
+            Y: T.Tensor((N, OC, H, W), out_dtype),
+    ):
+        with T.Kernel(T.ceildiv(W, tile_w), T.ceildiv(H, tile_h), is_cpu=True) as (bx, by):
+            x_tile = T.alloc_shared((1, C, in_h, in_w), dtype)
+            w_tile = T.alloc_shared((1, C, OC, 9), dtype)
+            y_tile = T.alloc_shared((1, OC, tile_h, tile_w), out_dtype)
+            q_tile = T.alloc_shared((1, OC, 1, 3), "int32")
+            T.ppl_copy(
+                X[0:1, 0:C, by * tile_h - 1:by * tile_h - 1 + in_h,
+                  bx * tile_w - 1:bx * tile_w - 1 + in_w],
+                x_tile,
+                pad_value=0)
+            T.ppl_copy(Wt, w_tile)
+            if requant:
+                T.ppl_copy(Q, q_tile)
+                T.ppl_conv2d(y_tile, x_tile, w_tile, 3, requant=q_tile)
+            else:
+                T.ppl_conv2d(y_tile, x_tile, w_tile, 3)
+            T.ppl_copy(y_tile, Y[0:1, 0:OC, by * tile_h:(by + 1) * tile_h,
+                                 bx * tile_w:(bx + 1) * tile_w])
+
+    return main
+
+
+def test_conv2d_halo_lowering():
+    source = tilelang.lower(conv3x3(1, 16, 64, 64, 32, 16, 16), target="tpu").kernel_source
+    # the window is clipped against the 64x64 image and the border padded
+    assert "int h_lo = MAX(0, -h0), h_hi = MAX(0, h0 + 18 - 64);" in source
+    assert "int w_lo = MAX(0, -w0), w_hi = MAX(0, w0 + 18 - 64);" in source
+    # only a clipped border is padded, then the valid part lands at
+    # (h_lo, w_lo) of the tile and is read from (h0 + h_lo, w0 + w_lo) of X
+    assert "if (h_lo || h_hi || w_lo || w_hi)\n" in source
+    assert ("tpu_bdc_set_C(x_tile.addr, (scalar_t){.f16 = 0}, &x_tile.shape, NULL, "
+            "DT_FP16);") in source
+    assert "dim4 global_stride = {65536, 4096, 64, 1} ;" in source
+    assert "tpu_gdma_cpy_S2L(x_tile.addr + (h_lo * local_stride.h + w_lo) * 2, " in source
+    assert ("(h0 + h_lo) * 64 + (w0 + w_lo)) * 2, &valid_shape, &local_stride, "
+            "&global_stride, DT_FP16);") in source
+    # the halo is fetched before the conv reads it
+    assert source.index("&valid_shape") < source.index("tpu_bdc_fp_conv2d(")
+    assert "dim2 kernel = {3, 3}, stride = {1, 1}, dilation = {1, 1};" in source
+    assert "padding_t padding = {0, 0, 0, 0};" in source
+    assert "DT_FP32, DT_FP16, false, false);" in source
+
+
+def conv_strided(C, OC, h, w, dtype="float16"):
+
+    @T.prim_func
+    def main(
+            X: T.Tensor((1, C, h, w), dtype),
+            Wt: T.Tensor((1, C, OC, 9), dtype),
+            Y: T.Tensor((1, OC, h // 2, w // 2), "float32"),
+    ):
+        with T.Kernel(1, is_cpu=True) as (bx,):
+            x_tile = T.alloc_shared((1, C, h, w), dtype)
+            w_tile = T.alloc_shared((1, C, OC, 9), dtype)
+            y_tile = T.alloc_shared((1, OC, h // 2, w // 2), "float32")
+            T.ppl_copy(X, x_tile)
+            T.ppl_copy(Wt, w_tile)
+            # the BDC pads the tile itself
+            T.ppl_conv2d(y_tile, x_tile, w_tile, 3, stride=2, padding=1)
+            T.ppl_copy(y_tile, Y)
+
+    return main
+
+
+def test_conv2d_stride_and_padding():
+    source = tilelang.lower(conv_strided(16, 32, 16, 16), target="tpu").kernel_source
+    assert "valid_shape" not in source
+    assert "dim2 kernel = {3, 3}, stride = {2, 2}, dilation = {1, 1};" in source
+    assert "padding_t padding = {1, 1, 1, 1};" in source
+
+
+def test_conv2d_int8_requant_lowering():
+    source = tilelang.lower(
+        conv3x3(1, 16, 64, 64, 32, 16, 16, dtype="int8", out_dtype="int8", requant=True),
+        target="tpu").kernel_source
+    # int32 accumulation, then per-channel requant into the int8 tile
+    assert "tpu_bdc_int8_sym_quant_conv2d(" in source
+    assert "tpu_bdc_int_pc_requant(" in source
+    assert source.index("tpu_bdc_int8_sym_quant_conv2d(") < source.index("tpu_bdc_int_pc_requant(")
+    assert "DT_INT8, DT_INT32, RM_HALF_AWAY_FROM_ZERO);" in source
+
+
+if __name__ == "__main__":
+    tilelang.testing.main()
@@ -0,0 +1,60 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+
+import tilelang
+import tilelang.testing
+import tilelang.language as T
+
+
+def grouped_gemm(total_M, N, K, num_experts, block_M, block_N, block_K, dtype="float16"):
+
+    @T.prim_func
+    def main(
+            A: T.Tensor((total_M, K), dtype),
+            B: T.Tensor((num_experts, K, N), dtype),
+            C: T.Tensor((total_M, N), "float32"),
+            offsets: T.Tensor((num_experts + 1,), "int32"),
+    ):
+        with T.Kernel(1, is_cpu=True) as (bx,):
+            T.ppl_grouped_gemm(A, B, C, offsets, block_M, block_N, block_K)
+
+    return main
+
+
+def test_grouped_gemm_lowering():
+    source = tilelang.lower(
+        grouped_gemm(512, 256, 256, 4, 64, 128, 128), target="tpu").kernel_source
+    # the routing is read on device, so the offsets are fetched fresh every call
+    assert "tpu_invalidate_cache(" in source and ".addr, (4 + 1) * sizeof(int));" in source
+    assert "int tiles = __ppl_grouped_tile_num(offsets, 4, 64, (256 + 128 - 1) / 128);" in source
+    # (expert, tile) pairs are dealt out round-robin, two k steps per tile
+    assert "core_idx + s / 2 * core_num, s % 2, &cur);" in source
+    # the loads of step s overlap the mm of step s - 1 and the store of s - 2
+    body = source[source.index("tpu_parallel_start();"):source.index("tpu_parallel_end();")]
+    assert body.index("tpu_gdma_cpy_S2L(") < body.index("tpu_bdc_fp_mm(") < body.index(
+        "tpu_gdma_cpy_L2S(")
+    assert "DT_FP32, DT_FP16, prev.k != 0);" in body
+    # the last tile is stored after the pipeline drains
+    assert source.count("tpu_gdma_cpy_L2S(") == 2
+
+
+def test_grouped_gemm_expert_addressing():
+    # K = 320 does not divide into block_K = 128: three k steps, the last one
+    # 64 deep, and a tile is only stored once its third step is done
+    source = tilelang.lower(
+        grouped_gemm(512, 256, 320, 4, 64, 128, 128), target="tpu").kernel_source
+    assert "core_idx + s / 3 * core_num, s % 3, &cur);" in source
+    assert "st->ks = MIN(block_k, K - st->k0);" in source
+    assert "if (s > 1 && done.k == 2) {" in source
+    # A rows come from the expert's slice of total_M, B from the expert's
+    # [K, N] matrix, ragged tiles load only their valid rows and columns.
+    # The kernel arguments A, B and C are described by v5, v6 and v7.
+    assert "dim4 a_shape = {1, cur.rows, 1, cur.ks};" in source
+    assert ("v5.addr + ((u64)cur.m0 * 320 + cur.k0) * 2, &a_shape, NULL, &a_stride, "
+            "DT_FP16);") in source
+    assert "v6.addr + (((u64)cur.expert * 320 + cur.k0) * 256 + cur.n0) * 2, " in source
+    assert "tpu_gdma_cpy_L2S(v7.addr + ((u64)done.m0 * 256 + done.n0) * 4, " in source
+
+
+if __name__ == "__main__":
+    tilelang.testing.main()
@@ -0,0 +1,48 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+
+import tilelang
+import tilelang.testing
+import tilelang.language as T
+
+
+def prefetch_rows(M, N, block_M, dtype="float32"):
+
+    @T.prim_func
+    def main(
+            A: T.Tensor((M, N), dtype),
+            B: T.Tensor((M, N), dtype),
+            C: T.Tensor((M, N), dtype),
+    ):
+        with T.Kernel(1, is_cpu=True) as (bx,):
+            A_shared = T.alloc_shared((block_M, N), dtype)
+            for k in T.serial(M // block_M - 1):
+                T.ppl_copy(A[k * block_M, 0], A_shared)
+                T.ppl_copy(A_shared, C[k * block_M, 0])
+                # the SDMA produces the rows of A the next iteration loads
+                T.ppl_copy(B[(k + 1) * block_M:(k + 2) * block_M, 0:N],
+                           A[(k + 1) * block_M:(k + 2) * block_M, 0:N])
+
+    return main
+
+
+def test_loop_carried_copy_lowering():
+    source = tilelang.lower(prefetch_rows(256, 128, 64), target="tpu").kernel_source
+    loop = source.index("for (int k")
+    # the byte offset of A's tile starts before the loop and moves by
+    # 64 rows * 128 * 4 bytes per iteration
+    assert source.index("long long A_offset = ") < loop
+    assert ".addr + A_offset" in source
+    step = source.index("A_offset += 32768;", loop)
+    # the SDMA write of A must land before the next iteration loads it, the
+    # wait follows the increments at the end of the body
+    sync = source.index("tpu_sync_all_sdma();", source.index("tpu_sdma_", loop))
+    assert step < sync < source.index("}", sync)
+    # the whole A_shared tile is passed with its allocation's descriptor
+    assert "tpu_gdma_cpy_S2L(A_shared.addr, " in source
+    assert "&A_shared.shape, NULL, &" in source
+    assert "__ppl_tensor_info A_shared_" not in source
+
+
+if __name__ == "__main__":
+    tilelang.testing.main()
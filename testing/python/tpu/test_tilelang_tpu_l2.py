@@ -0,0 +1,106 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+
+import pytest
+
+import tilelang
+import tilelang.testing
+import tilelang.language as T
+from tilelang import tvm as tvm
+from tilelang.tools import get_memory_plan
+
+
+def matmul_l2(M, N, K, block_M, block_N, block_K, dtype="float16", accum_dtype="float32"):
+
+    @T.prim_func
+    def main(
+            A: T.Tensor((M, K), dtype),
+            B: T.Tensor((K, N), dtype),
+            C: T.Tensor((M, N), accum_dtype),
+    ):
+        with T.Kernel(T.ceildiv(N, block_N), T.ceildiv(M, block_M), is_cpu=True) as (bx, by):
+            B_l2 = T.alloc_l2((K, N), dtype)
+            A_shared = T.alloc_shared((block_M, block_K), dtype)
+            B_shared = T.alloc_shared((block_K, block_N), dtype)
+            C_shared = T.alloc_shared((block_M, block_N), accum_dtype)
+            # B is read by every block, it is staged once for the whole chip
+            T.ppl_stage_l2(B, B_l2)
+            T.ppl_fill(C_shared, T.float32(0))
+            for k in T.serial(T.ceildiv(K, block_K)):
+                T.ppl_copy(A[by * block_M, k * block_K], A_shared)
+                T.ppl_copy(B_l2[k * block_K, bx * block_N], B_shared)
+                T.ppl_gemm(A_shared, B_shared, C_shared)
+            # the second k tile of the first column, a fixed non-zero row offset
+            T.ppl_copy(B_l2[block_K, 0], B_shared)
+            T.ppl_gemm(A_shared, B_shared, C_shared)
+            T.ppl_copy(C_shared, C[by * block_M, bx * block_N])
+
+    return main
+
+
+def stage_two(K, N, dtype="float16"):
+
+    @T.prim_func
+    def main(
+            S: T.Tensor((3, 50), dtype),
+            B: T.Tensor((K, N), dtype),
+            C: T.Tensor((K, N), dtype),
+    ):
+        with T.Kernel(1, is_cpu=True) as (bx,):
+            S_l2 = T.alloc_l2((3, 50), dtype)
+            B_l2 = T.alloc_l2((K, N), dtype)
+            B_shared = T.alloc_shared((K, N), dtype)
+            T.ppl_stage_l2(S, S_l2)
+            T.ppl_stage_l2(B, B_l2)
+            T.ppl_copy(B_l2[0, 0], B_shared)
+            T.ppl_copy(B_shared, C[0, 0])
+
+    return main
+
+def test_l2_tile_lowering():
+    source = tilelang.lower(matmul_l2(256, 128, 256, 128, 128, 64), target="tpu").kernel_source
+    # a 2D L2 tensor is laid out like a global one, rows step by stride.c
+    assert "__ppl_tensor_info B_l2 = {.shape = {1, 256, 1, 128} , " \
+           ".stride = {32768, 128, 128, 1} , .addr = L2_SRAM_START_ADDR + 0" in source
+    # row 64 of B_l2 is 64 * 128 elements in
+    assert "B_l2.addr + ((64) * 128+(0) * 1 ) * 2" in source
+    # the staging copy slices rows across the cores
+    assert "B_l2.stride.c * 2" in source
+
+
+def test_l2_sram_size_option():
+    func = matmul_l2(256, 128, 256, 128, 128, 64)
+    plan = get_memory_plan(tilelang.lower(func, target="tpu"))
+    assert plan["l2_capacity"] == 128 * 1024 * 1024
+    assert plan["l2_buffers"][0]["name"] == "B_l2"
+    with tvm.transform.PassContext(config={"tl.ppl_l2_sram_size": 1024 * 1024}):
+        plan = get_memory_plan(tilelang.lower(func, target="tpu"))
+    assert plan["l2_capacity"] == 1024 * 1024
+    # 256 x 128 fp16 is 64 KB, it does not fit a 32 KB L2
+    with tvm.transform.PassContext(config={"tl.ppl_l2_sram_size": 32 * 1024}):
+        with pytest.raises(tvm.error.TVMError):
+            tilelang.lower(func, target="tpu")
+
+
+def test_l2_allocator_layout():
+    func = stage_two(64, 128)
+    artifact = tilelang.lower(func, target="tpu")
+    l2 = {buf["name"]: buf for buf in get_memory_plan(artifact)["l2_buffers"]}
+    # 3 x 50 fp16 is 300 bytes, 64 x 128 fp16 is 16 KB
+    assert l2["S_l2"]["size"] == 300
+    assert l2["B_l2"]["size"] == 64 * 128 * 2
+    # L2 buffers never share space: one after the other, 128 byte aligned
+    first, second = sorted(l2.values(), key=lambda buf: buf["addr"])
+    assert first["addr"] == 0
+    assert second["addr"] == (first["size"] + 127) // 128 * 128
+    assert f".addr = L2_SRAM_START_ADDR + {second['addr']}" in artifact.kernel_source
+    # the aligned total, 384 + 16384 bytes, is what has to fit
+    need = 384 + 64 * 128 * 2
+    with tvm.transform.PassContext(config={"tl.ppl_l2_sram_size": need}):
+        tilelang.lower(func, target="tpu")
+    with tvm.transform.PassContext(config={"tl.ppl_l2_sram_size": need - 1}):
+        with pytest.raises(tvm.error.TVMError, match="L2 buffers need 16768 bytes"):
+            tilelang.lower(func, target="tpu")
+
+if __name__ == "__main__":
+    tilelang.testing.main()
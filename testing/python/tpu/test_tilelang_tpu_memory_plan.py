@@ -0,0 +1,53 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+
+import tilelang
+import tilelang.testing
+import tilelang.language as T
+from tilelang.tools import get_memory_plan, format_memory_plan
+
+
+def matmul(M, N, K, block_M, block_N, block_K, dtype="float16", accum_dtype="float32"):
+
+    @T.prim_func
+    def main(
+            A: T.Tensor((M, K), dtype),
+            B: T.Tensor((K, N), dtype),
+            C: T.Tensor((M, N), accum_dtype),
+    ):
+        with T.Kernel(T.ceildiv(N, block_N), T.ceildiv(M, block_M), is_cpu=True) as (bx, by):
+            A_shared = T.alloc_shared((block_M, block_K), dtype)
+            B_shared = T.alloc_shared((block_K, block_N), dtype)
+            C_shared = T.alloc_shared((block_M, block_N), accum_dtype)
+            T.ppl_fill(C_shared, T.float32(0))
+            for k in T.serial(T.ceildiv(K, block_K)):
+                T.ppl_copy(A[by * block_M, k * block_K], A_shared)
+                T.ppl_copy(B[k * block_K, bx * block_N], B_shared)
+                T.ppl_gemm(A_shared, B_shared, C_shared)
+            T.ppl_copy(C_shared, C[by * block_M, bx * block_N])
+
+    return main
+
+
+def test_memory_plan():
+    artifact = tilelang.lower(matmul(256, 256, 256, 128, 128, 64), target="tpu")
+    plan = get_memory_plan(artifact)
+    assert plan["success"]
+    names = {b["name"] for b in plan["buffers"]}
+    assert {"A_shared", "B_shared", "C_shared"} <= names
+    for buf in plan["buffers"]:
+        assert 0 <= buf["addr"] < plan["capacity"]
+        assert buf["addr"] // plan["bank_size"] == buf["bank_start"] <= buf["bank_end"]
+        assert buf["live_start"] <= buf["live_end"]
+    # the accumulator is live from the fill to the store, across the k loop
+    c_shared = next(b for b in plan["buffers"] if b["name"] == "C_shared")
+    assert all(c_shared["live_start"] <= b["live_start"] for b in plan["buffers"])
+    assert plan["used"] <= plan["capacity"]
+    assert "C_shared" in plan["peak_buffers"]
+    # the allocator keeps all buffers apart, the live intervals are a report
+    assert plan["live_estimated"]
+    assert "estimated peak live" in format_memory_plan(plan)
+
+
+if __name__ == "__main__":
+    tilelang.testing.main()
@@ -0,0 +1,37 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+
+import tilelang.testing
+from tilelang.profiler.ppl_profile import decode_ppl_profile, format_ppl_profile
+
+LOG = """\
+[perf][info] [0] ---> gdma record #0, inst_id=0, thread_id=0, cycle=100, start=0.000us, end=0.100us, interval=0.100us, ar_latency_cnt=0, rip_valid_latency=0, gif_wr_rd_stall_cntr= 0
+[perf][info] [0] ---> gdma record #1, inst_id=1, thread_id=0, cycle=120, start=0.100us, end=0.220us, interval=0.120us, ar_latency_cnt=0, rip_valid_latency=0, gif_wr_rd_stall_cntr= 0
+[perf][info] [0] ---> bdc record #0, inst_id=0, thread_id=0, cycle=40, start=0.000us, end=0.040us, interval=0.040us, bank_conflict=0
+[perf][info] [0] ---> bdc record #1, inst_id=1, thread_id=0, cycle=500, start=0.300us, end=0.800us, interval=0.500us, bank_conflict=0
+[perf][info] [0] ---> bdc record #2, inst_id=2, thread_id=0, cycle=7, start=0.800us, end=0.807us, interval=0.007us, bank_conflict=0
+[ppl_prof] stmt=0 bd=0:1 gdma=0:0 op=T.call_extern("handle", "ppl.fill", C_shared, T.float32(0))
+[ppl_prof] stmt=1 bd=1:1 gdma=0:1 op=T.call_extern("handle", "ppl.copy", A, A_shared)
+[ppl_prof] stmt=1 bd=1:1 gdma=1:2 op=T.call_extern("handle", "ppl.copy", A, A_shared)
+[ppl_prof] stmt=2 bd=1:2 gdma=2:2 op=T.call_extern("handle", "ppl.gemm", A_shared, B_shared, C_shared)
+[ppl_prof] records=4 dropped=0
+"""
+
+
+def test_decode_ppl_profile():
+    profile = decode_ppl_profile(LOG)
+    assert [s.op for s in profile.stmts] == ["ppl.fill", "ppl.copy", "ppl.gemm"]
+    fill, copy, gemm = profile.stmts
+    assert fill.cycles == {"bdc": 40, "gdma": 0}
+    assert copy.count == 2
+    assert copy.instructions == {"bdc": 0, "gdma": 2}
+    assert copy.cycles["gdma"] == 220
+    assert gemm.cycles["bdc"] == 500
+    assert profile.unattributed_cycles == {"bdc": 7, "gdma": 0}
+    table = format_ppl_profile(profile)
+    # the gemm dominates and is listed first
+    assert table.splitlines()[1].split()[1] == "ppl.gemm"
+
+
+if __name__ == "__main__":
+    tilelang.testing.main()
@@ -0,0 +1,92 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+
+import tilelang
+import tilelang.testing
+import tilelang.language as T
+
+
+def quant_roundtrip(M, N, block_M, block_N):
+
+    @T.prim_func
+    def main(
+            X: T.Tensor((M, N), "float32"),
+            S: T.Tensor((block_M, 2), "float32"),
+            Y: T.Tensor((M, N), "float32"),
+    ):
+        with T.Kernel(T.ceildiv(N, block_N), T.ceildiv(M, block_M), is_cpu=True) as (bx, by):
+            x = T.alloc_shared((block_M, block_N), "float32")
+            s = T.alloc_shared((block_M, 2), "float32")
+            q_t = T.alloc_shared((block_M, block_N), "int8")
+            q_c = T.alloc_shared((block_M, block_N), "int8")
+            y = T.alloc_shared((block_M, block_N), "float32")
+            T.ppl_copy(X[by * block_M, bx * block_N], x)
+            T.ppl_copy(S, s)
+            T.ppl_quantize(q_t, x, scale=0.5, zero_point=3.0)
+            T.ppl_quantize(q_c, x, quant=s)
+            T.ppl_dequantize(y, q_t, scale=0.5, zero_point=3.0)
+            T.ppl_dequantize(x, q_c, quant=s)
+            T.ppl_add(y, y, x)
+            T.ppl_copy(y, Y[by * block_M, bx * block_N])
+
+    return main
+
+
+def weight_only_matmul(M, N, K, block_M, block_N, group_size, b_bits):
+    # b_bits=4 packs two weights into every int8 byte along N
+    pack = 8 // b_bits
+
+    @T.prim_func
+    def main(
+            A: T.Tensor((M, K), "float16"),
+            B: T.Tensor((K, N // pack), "int8"),
+            Q: T.Tensor((K, N // group_size * 2), "float16"),
+            C: T.Tensor((M, N), "float32"),
+    ):
+        with T.Kernel(T.ceildiv(N, block_N), T.ceildiv(M, block_M), is_cpu=True) as (bx, by):
+            A_shared = T.alloc_shared((block_M, K), "float16")
+            B_shared = T.alloc_shared((K, block_N // pack), "int8")
+            Q_shared = T.alloc_shared((K, block_N // group_size * 2), "float16")
+            C_shared = T.alloc_shared((block_M, block_N), "float32")
+            T.ppl_fill(C_shared, T.float32(0))
+            T.ppl_copy(A[by * block_M, 0], A_shared)
+            T.ppl_copy(B[0, bx * block_N // pack], B_shared)
+            T.ppl_copy(Q[0, bx * block_N // group_size * 2], Q_shared)
+            T.ppl_gemm(A_shared, B_shared, C_shared, b_quant=Q_shared, group_size=group_size,
+                       b_bits=b_bits)
+            T.ppl_copy(C_shared, C[by * block_M, bx * block_N])
+
+    return main
+
+
+def test_quantize_dequantize_lowering():
+    source = tilelang.lower(quant_roundtrip(256, 256, 64, 64), target="tpu").kernel_source
+    assert ("&q_t.shape, 0.5, 3, DT_INT8, DT_FP32, RM_HALF_TO_EVEN, RM_HALF_TO_EVEN);"
+            in source)
+    assert "tpu_bdc_fp32_pc_requant(q_c.addr, x.addr, s.addr, &q_c.shape," in source
+    assert "tpu_bdc_fp32_dequant(y.addr, q_t.addr, &y.shape," in source
+    assert "0.5, DT_INT8, RM_HALF_TO_EVEN);" in source
+    assert "tpu_bdc_fp32_pc_dequant(x.addr, q_c.addr, s.addr, &x.shape, DT_INT8," in source
+
+
+def test_weight_only_gemm_lowering():
+    source = tilelang.lower(
+        weight_only_matmul(128, 256, 128, 64, 128, 64, 4), target="tpu").kernel_source
+    # the 128x64 bytes of B are unpacked from int4 into a 128x128 fp16 scratch,
+    # one (scale, zp) pair of Q per 64 weights, right before the mm
+    assert "b_scratch = {.shape = {1, 128, 1, 128}, " in source
+    dequant = source.index("tpu_bdc_f16_group_dequant(b_scratch.addr, B_shared.addr, "
+                           "Q_shared.addr, &b_scratch.shape, DT_INT4, DT_FP16, 64);")
+    mm = next(line for line in source.splitlines() if "tpu_bdc_fp_mm(" in line)
+    assert "b_scratch" in mm and "B_shared" not in mm
+    assert dequant < source.index("tpu_bdc_fp_mm(")
+
+
+def test_weight_only_int8_gemm_lowering():
+    source = tilelang.lower(
+        weight_only_matmul(128, 256, 128, 64, 128, 128, 8), target="tpu").kernel_source
+    assert ("tpu_bdc_f16_group_dequant(b_scratch.addr, B_shared.addr, Q_shared.addr, "
+            "&b_scratch.shape, DT_INT8, DT_FP16, 128);") in source
+
+if __name__ == "__main__":
+    tilelang.testing.main()
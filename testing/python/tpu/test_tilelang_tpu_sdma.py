@@ -0,0 +1,118 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+
+import tilelang
+import tilelang.testing
+import tilelang.language as T
+
+
+def store_then_forward(M, N, block_M, dtype="float32"):
+
+    @T.prim_func
+    def main(
+            A: T.Tensor((M, N), dtype),
+            Acc: T.Tensor((M, N), dtype),
+            Out: T.Tensor((M, N), dtype),
+    ):
+        with T.Kernel(1, is_cpu=True) as (bx,):
+            tile = T.alloc_shared((block_M, N), dtype)
+            for k in T.serial(M // block_M):
+                T.ppl_copy(A[k * block_M, 0], tile)
+                T.ppl_copy(tile, Acc[k * block_M, 0])
+                # forwarded by the SDMA right after the GDMA store
+                T.ppl_copy(Acc[k * block_M:(k + 1) * block_M, 0:N],
+                           Out[k * block_M:(k + 1) * block_M, 0:N])
+
+    return main
+
+
+def independent_copies(M, N, block_M, dtype="float32"):
+
+    @T.prim_func
+    def main(
+            A: T.Tensor((M, N), dtype),
+            B: T.Tensor((M, N), dtype),
+            D: T.Tensor((M, N), dtype),
+            C: T.Tensor((M, N), dtype),
+    ):
+        with T.Kernel(1, is_cpu=True) as (bx,):
+            tile = T.alloc_shared((block_M, N), dtype)
+            for k in T.serial(M // block_M):
+                # B and D are never touched by the GDMA
+                T.ppl_copy(B[k * block_M:(k + 1) * block_M, 0:N],
+                           D[k * block_M:(k + 1) * block_M, 0:N])
+                T.ppl_copy(A[k * block_M, 0], tile)
+                T.ppl_copy(tile, C[k * block_M, 0])
+
+    return main
+
+
+def append_rows(M, N, block_M, dtype="float32"):
+
+    @T.prim_func
+    def main(
+            Src: T.Tensor((M, N), dtype),
+            Cache: T.Tensor((M, N), dtype),
+    ):
+        with T.Kernel(1, is_cpu=True) as (bx,):
+            for k in T.serial(M // block_M):
+                # the valid prefix grows every iteration
+                T.ppl_copy(Src[0:(k + 1) * block_M, 0:N], Cache[0:(k + 1) * block_M, 0:N])
+
+    return main
+
+
+def fill_int(M, N, dtype="int32"):
+
+    @T.prim_func
+    def main(Out: T.Tensor((M, N), dtype),):
+        with T.Kernel(1, is_cpu=True) as (bx,):
+            tile = T.alloc_shared((M, N), dtype)
+            T.ppl_fill(tile, 7)
+            T.ppl_fill(Out, 0)
+            T.ppl_copy(tile, Out[0, 0])
+
+    return main
+
+
+def test_sdma_waits_for_gdma_store():
+    source = tilelang.lower(store_then_forward(256, 128, 64), target="tpu").kernel_source
+    loop = source[source.index("for (int k"):]
+    sdma = loop.index("tpu_sdma_")
+    # the store to Acc is waited for before the SDMA reads it
+    assert loop.index("tpu_gdma_cpy_L2S(") < loop.index("tpu_sync_all_gdma();") < sdma
+    # the next iteration stores to Acc again while the SDMA may still read it,
+    # so the body ends with a wait
+    assert loop.index("tpu_sync_all_sdma();", sdma) < loop.index("}", sdma)
+
+
+def test_sdma_sync_only_on_hazard():
+    source = tilelang.lower(independent_copies(256, 128, 64), target="tpu").kernel_source
+    assert "tpu_sdma_" in source
+    # no buffer is shared between the engines: neither the body nor the loop
+    # end waits, only the end of the kernel does
+    assert source.count("tpu_sync_all_sdma();") == 1
+    assert "tpu_sync_all_gdma();" not in source
+    assert source.index("tpu_sync_all_sdma();") > source.rindex("tpu_gdma_cpy_L2S(")
+
+
+def test_sdma_copy_runtime_extent():
+    source = tilelang.lower(append_rows(256, 128, 64), target="tpu").kernel_source
+    # the element count is unknown at compile time, the strided copy takes
+    # the runtime shape from the descriptors
+    assert "tpu_sdma_cpy_S2S(" in source
+    assert "tpu_sdma_system_cpy(" not in source
+    shape = source[source.index("{.shape = {1, "):]
+    assert "k" in shape[:shape.index("}")]
+
+
+def test_fill_integer_value():
+    source = tilelang.lower(fill_int(64, 128), target="tpu").kernel_source
+    assert "tpu_bdc_set_C(" in source
+    assert "(scalar_t){.s32 = 7}" in source
+    assert "(scalar_t){.s32 = 0}" in source
+    assert "tpu_sdma_system_set(" in source
+
+
+if __name__ == "__main__":
+    tilelang.testing.main()
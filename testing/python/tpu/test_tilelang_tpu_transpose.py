@@ -0,0 +1,52 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+
+import tilelang
+import tilelang.testing
+import tilelang.language as T
+
+
+def transpose(M, N, block_M, block_N, dtype="float16"):
+
+    @T.prim_func
+    def main(
+            A: T.Tensor((M, N), dtype),
+            B: T.Tensor((N, M), dtype),
+            C: T.Tensor((N, M), dtype),
+    ):
+        with T.Kernel(T.ceildiv(N, block_N), T.ceildiv(M, block_M), is_cpu=True) as (bx, by):
+            A_t = T.alloc_shared((block_N, block_M), dtype)
+            A_tt = T.alloc_shared((block_M, block_N), dtype)
+            # fused into the load
+            T.ppl_transpose(A[by * block_M:(by + 1) * block_M, bx * block_N:(bx + 1) * block_N],
+                            A_t)
+            T.ppl_copy(A_t, B[bx * block_N, by * block_M])
+            # local to local, then fused into the store
+            T.ppl_transpose(A_t, A_tt)
+            T.ppl_transpose(A_tt, C[bx * block_N:(bx + 1) * block_N,
+                                    by * block_M:(by + 1) * block_M])
+
+    return main
+
+
+def test_transpose_lowering():
+    # non-square tiles so the swapped c and w dims show in the descriptors
+    source = tilelang.lower(transpose(256, 256, 64, 32), target="tpu").kernel_source
+    # the load reads a 64x32 slice of A into the 32x64 A_t
+    load = source.index("tpu_gdma_cpy_cw_trans_S2L(A_t.addr, ")
+    assert "{.shape = {1, 64, 1, 32}, " in source[:load]
+    assert "&A_t.shape, " in source[load:source.index(";", load)]
+    # the store writes A_tt (64x32) to a 32x64 slice of C
+    store = source.index("tpu_gdma_cpy_cw_trans_L2S(")
+    assert "{.shape = {1, 32, 1, 64}, " in source[load:store]
+    assert ", A_tt.addr, &" in source[store:source.index(";", store)]
+    # dense local tiles use the BDC when c and w fit in the NPUs, the GDMA
+    # otherwise
+    bdc = source.index("tpu_bdc_cw_trans(A_tt.addr, A_t.addr, &A_tt.shape, DT_FP16);")
+    guard = source.rindex("if (", 0, bdc)
+    assert source[guard:bdc].startswith(
+        "if (A_tt.shape.c <= NPU_NUM && A_tt.shape.w <= NPU_NUM) {")
+    assert "tpu_gdma_cpy_cw_trans_L2L(A_tt.addr, A_t.addr, &A_tt.shape, " in source[bdc:]
+
+if __name__ == "__main__":
+    tilelang.testing.main()
@@ -0,0 +1,97 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+from tilelang import tvm as tvm
+import tilelang as tl
+import tilelang.language as T
+import tilelang.testing
+
+M = 64
+N = 64
+dtype = "float32"
+
+
+def _fuse(func):
+    mod = tvm.IRModule.from_expr(func.with_attr("global_symbol", "main"))
+    mod = tl.transform.FusePPLElementwise()(mod)
+    return mod["main"].script()
+
+
+def test_fold_dominating_fill():
+
+    @T.prim_func
+    def main(A: T.Tensor((M, N), dtype), B: T.Tensor((M, N), dtype)):
+        with T.Kernel(1, is_cpu=True) as (bx,):
+            x = T.alloc_shared((M, N), dtype)
+            y = T.alloc_shared((M, N), dtype)
+            c = T.alloc_shared((M, N), dtype)
+            T.ppl_fill(c, T.float32(2))
+            T.ppl_copy(A[0, 0], x)
+            T.ppl_add(y, x, c)
+            T.ppl_copy(y, B[0, 0])
+
+    script = _fuse(main)
+    assert "ppl.add_C" in script
+    assert '"ppl.add",' not in script
+    # the filled buffer has no reader left
+    assert "ppl.fill" not in script
+
+
+def test_keep_fill_after_use():
+
+    @T.prim_func
+    def main(A: T.Tensor((M, N), dtype), B: T.Tensor((M, N), dtype)):
+        with T.Kernel(1, is_cpu=True) as (bx,):
+            x = T.alloc_shared((M, N), dtype)
+            y = T.alloc_shared((M, N), dtype)
+            c = T.alloc_shared((M, N), dtype)
+            T.ppl_copy(A[0, 0], x)
+            T.ppl_add(y, x, c)
+            T.ppl_fill(c, T.float32(2))
+            T.ppl_copy(y, B[0, 0])
+
+    script = _fuse(main)
+    assert "ppl.add_C" not in script
+    assert '"ppl.add",' in script
+
+
+def test_keep_fill_overwritten_by_copy():
+
+    @T.prim_func
+    def main(A: T.Tensor((M, N), dtype), B: T.Tensor((M, N), dtype)):
+        with T.Kernel(1, is_cpu=True) as (bx,):
+            x = T.alloc_shared((M, N), dtype)
+            y = T.alloc_shared((M, N), dtype)
+            c = T.alloc_shared((M, N), dtype)
+            T.ppl_fill(c, T.float32(0))
+            # the copy writes c through a tl.region, the zeros are gone
+            T.ppl_copy(A[0, 0], c)
+            T.ppl_copy(A[0, 0], x)
+            T.ppl_add(y, x, c)
+            T.ppl_copy(y, B[0, 0])
+
+    script = _fuse(main)
+    assert "ppl.add_C" not in script
+    assert '"ppl.add",' in script
+
+
+def test_keep_fill_under_if():
+
+    @T.prim_func
+    def main(A: T.Tensor((M, N), dtype), B: T.Tensor((M, N), dtype)):
+        with T.Kernel(2, is_cpu=True) as (bx,):
+            x = T.alloc_shared((M, N), dtype)
+            y = T.alloc_shared((M, N), dtype)
+            c = T.alloc_shared((M, N), dtype)
+            if bx == 0:
+                T.ppl_fill(c, T.float32(2))
+            T.ppl_copy(A[0, 0], x)
+            T.ppl_add(y, x, c)
+            T.ppl_copy(y, B[0, 0])
+
+    script = _fuse(main)
+    assert "ppl.add_C" not in script
+    assert "ppl.fill" in script
+
+
+if __name__ == "__main__":
+    tilelang.testing.main()
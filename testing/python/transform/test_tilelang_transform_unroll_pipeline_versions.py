@@ -0,0 +1,80 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+from tilelang import tvm as tvm
+import tilelang as tl
+import tilelang.language as T
+import tilelang.testing
+from tilelang.tools import get_memory_plan
+from tvm import tir
+
+
+def versioned_copy(num_iters, num_versions=2):
+
+    @T.prim_func
+    def main(A: T.Tensor((num_iters * 64, 64), "float16")):
+        A_shared_0 = T.decl_buffer((64, 64), "float16", scope="shared.dyn")
+        A_shared_1 = T.decl_buffer((64, 64), "float16", scope="shared.dyn")
+        for k in T.serial(num_iters):
+            T.evaluate(
+                T.call_extern(
+                    "handle", "copy",
+                    T.if_then_else(
+                        T.floormod(k, num_versions) == 0, A_shared_0.data, A_shared_1.data),
+                    A.data, k * 64))
+
+    return main
+
+
+def _unroll(func):
+    mod = tvm.IRModule.from_expr(func.with_attr("global_symbol", "main"))
+    mod = tl.transform.UnrollPipelineVersions()(mod)
+    mod = tir.transform.Simplify()(mod)
+    return mod
+
+
+def _loops(func):
+    loops = []
+    tir.stmt_functor.post_order_visit(
+        func.body, lambda node: loops.append(node) if isinstance(node, tir.For) else None)
+    return loops
+
+
+def test_unroll_pipeline_versions():
+    mod = _unroll(versioned_copy(8))
+    func = mod["main"]
+    loops = _loops(func)
+    assert len(loops) == 1
+    assert int(loops[0].extent) == 4
+    script = func.script()
+    # every copy of the body refers to a fixed version
+    assert "if_then_else" not in script
+    assert script.count("A_shared_0.data") == 1
+    assert script.count("A_shared_1.data") == 1
+    groups = func.attrs["tl.pipeline_versions"]
+    assert [[str(name) for name in group] for group in groups] == [["A_shared_0", "A_shared_1"]]
+
+
+def test_unroll_pipeline_versions_remainder():
+    # 5 iterations: two unrolled pairs and one peeled copy of version 0
+    func = _unroll(versioned_copy(5))["main"]
+    loops = _loops(func)
+    assert len(loops) == 1
+    assert int(loops[0].extent) == 2
+    assert func.script().count("A_shared_0.data") == 2
+
+
+def test_sibling_versions_distinct_banks():
+    mod = _unroll(versioned_copy(8))
+    mod = tl.transform.AddressAssign()(mod)
+    plan = get_memory_plan(mod)
+    assert plan["success"]
+    bufs = {b["name"]: b for b in plan["buffers"]}
+    v0, v1 = bufs["A_shared_0"], bufs["A_shared_1"]
+    # GDMA writes one version while BDC reads the other, they never share a bank
+    assert v0["bank_end"] < v1["bank_start"] or v1["bank_end"] < v0["bank_start"]
+    assert int(mod["main"].attrs["A_shared_0"]) == v0["addr"]
+    assert int(mod["main"].attrs["A_shared_1"]) == v1["addr"]
+
+
+if __name__ == "__main__":
+    tilelang.testing.main()
@@ -16,6 +16,7 @@ import cloudpickle
 import logging
 
 from tilelang.env import TILELANG_CACHE_DIR, is_cache_enabled
+from tilelang.jit.adapter.libgen import cpu_arch_key
 
 KERNEL_PATH = "kernel.cu"
 WRAPPED_KERNEL_PATH = "warpped_kernel.cu"
@@ -94,6 +95,10 @@ class KernelCache:
             "target_host": str(target_host) if target_host else None,
             "execution_backend": execution_backend,
         }
+        target_kind = target.kind.name if isinstance(target, Target) else str(target).split()[0]
+        if target_kind in ("llvm", "c"):
+            # a CPU kernel built with -march=native only runs on a matching host
+            key_data["cpu_arch"] = cpu_arch_key()
         key_string = json.dumps(key_data, sort_keys=True)  # Sort keys to ensure consistency
         return sha256(key_string.encode()).hexdigest()  # Use SHA256 to generate hash key
 
@@ -4,12 +4,16 @@ from .arch_base import TileDevice
 from .cuda import CUDA
 from .cpu import CPU
 from .cdna import CDNA
+from .tpu import TPU
 from typing import Union
 from tvm.target import Target
 
 
 def get_arch(target: Union[str, Target] = "cuda") -> TileDevice:
     if isinstance(target, str):
+        # the TPU backend is not a TVM target kind
+        if target.split()[0] == "tpu":
+            return TPU(target)
         target = Target(target)
 
     if target.kind.name == "cuda":
@@ -39,3 +43,4 @@ from .cuda import (
     has_mma_support,  # noqa: F401
 )
 from .cdna import is_cdna_arch  # noqa: F401
+from .tpu import is_tpu_arch  # noqa: F401
@@ -0,0 +1,136 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+
+import os
+from dataclasses import dataclass, replace
+from typing import Dict, Optional
+from .arch_base import TileDevice
+
+
+def is_tpu_arch(arch: TileDevice) -> bool:
+    return isinstance(arch, TPU)
+
+
+@dataclass(frozen=True)
+class TPUChipSpec:
+    """Per-core resources of a Sophgo TPU as seen by the PPL backend."""
+    npu_num: int  # lanes (NPUs) a local tensor's channel dim is spread over
+    eu_bytes: int  # bytes one NPU processes per cycle, EU_NUM * sizeof(float)
+    local_mem_per_npu: int  # bytes of local memory per NPU
+    bank_num: int  # local memory banks per NPU
+    core_num: int  # TPU cores that can run blocks concurrently
+    freq_mhz: int  # BDC clock
+    gdma_bandwidth: float  # GB/s between global and local memory, per core
+    # peak BDC matmul throughput per core in TFLOPS (TOPS for int8)
+    matmul_tflops: Dict[str, float]
+    l2_sram_size: int = 0
+    # fixed issue/sync cost of one BDC or GDMA command
+    cmd_overhead_cycles: int = 100
+
+
+# Nominal figures from the chip datasheets. The local memory geometry must
+# agree with the bank model used by the AddressAssign pass.
+TPU_CHIP_SPECS: Dict[str, TPUChipSpec] = {
+    "bm1684x":
+        TPUChipSpec(
+            npu_num=64,
+            eu_bytes=64,
+            local_mem_per_npu=256 * 1024,
+            bank_num=16,
+            core_num=1,
+            freq_mhz=1000,
+            gdma_bandwidth=64.0,
+            matmul_tflops={
+                "float32": 2.0,
+                "float16": 16.0,
+                "bfloat16": 16.0,
+                "int8": 32.0,
+            },
+        ),
+    "bm1690":
+        TPUChipSpec(
+            npu_num=64,
+            eu_bytes=64,
+            local_mem_per_npu=256 * 1024,
+            bank_num=16,
+            core_num=8,
+            freq_mhz=1000,
+            gdma_bandwidth=128.0,
+            matmul_tflops={
+                "float32": 2.0,
+                "float16": 32.0,
+                "bfloat16": 32.0,
+                "int8": 64.0,
+            },
+            l2_sram_size=128 * 1024 * 1024,
+        ),
+}
+
+
+class TPU(TileDevice):
+    """Sophgo TPU driven through the PPL backend.
+
+    A local tensor lays its channel dimension across ``npu_num`` NPUs and each
+    row is padded to the EU width, so capacity questions are answered per NPU.
+    ``target`` may carry the chip as ``"tpu -chip=bm1690"``; otherwise the
+    ``CHIP`` environment variable used by the TPU adapter decides.
+    """
+
+    def __init__(self, target: str = "tpu", chip: Optional[str] = None, **overrides):
+        super().__init__()
+        self.target = target
+        if chip is None:
+            for opt in str(target).split()[1:]:
+                if opt.startswith("-chip="):
+                    chip = opt[len("-chip="):]
+        if chip is None:
+            chip = os.environ.get("CHIP", "bm1690")
+        if chip not in TPU_CHIP_SPECS:
+            raise ValueError(f"Unsupported TPU chip: {chip}, "
+                             f"expected one of {list(TPU_CHIP_SPECS)}")
+        # e.g. TPU(gdma_bandwidth=64.0) to model a slower memory system
+        spec = replace(TPU_CHIP_SPECS[chip], **overrides)
+
+        self.chip: str = chip
+        self.spec: TPUChipSpec = spec
+        self.platform: str = "TPU"
+        self.npu_num: int = spec.npu_num
+        self.eu_bytes: int = spec.eu_bytes
+        self.local_mem_per_npu: int = spec.local_mem_per_npu
+        self.bank_num: int = spec.bank_num
+        self.bank_size: int = spec.local_mem_per_npu // spec.bank_num
+        self.freq_mhz: int = spec.freq_mhz
+        self.gdma_bandwidth: float = spec.gdma_bandwidth
+        self.l2_cache_size_bytes: int = spec.l2_sram_size
+
+        # generic TileDevice view: a block runs on one core and owns its local memory
+        self.compute_max_core = spec.core_num
+        self.smem_cap = spec.local_mem_per_npu * spec.npu_num
+        self.max_smem_usage = self.smem_cap
+        self.warp_size = 1
+        self.sm_partition = 1
+        self.transaction_size = [spec.eu_bytes, spec.eu_bytes]
+        self.bandwidth = [int(spec.gdma_bandwidth * 1000), int(spec.gdma_bandwidth * 1000)]
+
+    @property
+    def cmd_overhead_us(self) -> float:
+        return self.spec.cmd_overhead_cycles / self.freq_mhz
+
+    def eu_num(self, dtype_bits: int) -> int:
+        """Elements of ``dtype_bits`` width one NPU processes per cycle."""
+        return max(self.eu_bytes * 8 // dtype_bits, 1)
+
+    def matmul_tflops(self, dtype: str) -> float:
+        """Peak matmul throughput for ``dtype`` inputs, falling back to fp32."""
+        table = self.spec.matmul_tflops
+        return table.get(dtype, table["float32"])
+
+    def vector_gops(self, dtype_bits: int) -> float:
+        """Peak elementwise throughput in giga elements per second."""
+        return self.npu_num * self.eu_num(dtype_bits) * self.freq_mhz / 1000
+
+    def get_avaliable_tensorintrin_shapes(self):
+        return []
+
+    def __repr__(self) -> str:
+        return f"TPU({self.chip})"
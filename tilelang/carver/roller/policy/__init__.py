@@ -3,3 +3,4 @@
 
 from .default import DefaultPolicy  # noqa: F401
 from .tensorcore import TensorCorePolicy  # noqa: F401
+from .tpu import TPUPolicy  # noqa: F401
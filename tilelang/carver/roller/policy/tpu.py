@@ -0,0 +1,187 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+"""Policy for Sophgo TPU (PPL backend) tile selection"""
+import itertools
+import math
+from typing import Dict, List, Optional
+
+import numpy as np
+
+from ...arch import TileDevice, is_tpu_arch
+from ..hint import Hint
+from ..node import PrimFuncNode
+from .common import get_all_factors
+from .default import DefaultPolicy
+
+
+class TPUTileEstimate:
+    """Local memory footprint and modelled latency of one tile configuration."""
+
+    def __init__(self, tile: List[int], rstep: Dict[str, int], num_stages: int) -> None:
+        self.tile = tile
+        self.rstep = rstep
+        self.num_stages = num_stages
+        self.local_mem_per_npu = 0
+        self.banks = 0
+        self.grid_size = 0
+        self.num_wave = 0
+        self.steps = 1
+        self.dma_us = 0.0  # per reduction step
+        self.compute_us = 0.0  # per reduction step
+        self.store_us = 0.0  # per tile
+        self.latency_us = 0.0  # whole kernel
+
+    def __repr__(self) -> str:
+        return (f"<TPUTile {self.tile} rstep={self.rstep} stages={self.num_stages} "
+                f"banks={self.banks} latency={self.latency_us:.2f}us>")
+
+
+class TPUPolicy(DefaultPolicy):
+    """
+    Roller policy for the TPU: a block is executed by one core and keeps all its
+    tiles in that core's local memory, so instead of thread mapping the policy
+    enumerates tile shapes whose ``num_stages``-buffered inputs fit the local
+    memory banks and ranks them with an analytic GDMA/BDC overlap model.
+    """
+
+    def __init__(self, arch: TileDevice, tags: Optional[Dict] = None, num_stages: int = 2) -> None:
+        if not is_tpu_arch(arch):
+            raise ValueError(f"TPUPolicy requires a TPU arch, got {arch}")
+        super().__init__(arch, tags)
+        self.num_stages = num_stages
+
+    def emit_config(self, topk: int) -> List[Hint]:
+        node = self.output_nodes[0]
+        estimates = []
+        for tile in self._space_tile_candidates(node):
+            for rstep in self._reduce_step_candidates(node):
+                for num_stages in sorted({1, self.num_stages}, reverse=True):
+                    est = self.estimate(node, tile, rstep, num_stages)
+                    if est is not None:
+                        estimates.append(est)
+        # prefer the faster tile, then the one with fewer waves and more reuse
+        estimates.sort(key=lambda e: (e.latency_us, e.num_wave, -int(np.prod(e.tile))))
+        results = []
+        for est in estimates[:topk]:
+            results.append(self._to_hint(node, est))
+        return results
+
+    def _aligned_candidates(self, extent: int, align: int) -> List[int]:
+        """Factors and powers of two of ``extent`` that are full or ``align`` aligned."""
+        cands = set(get_all_factors(extent))
+        p = 1
+        while p < extent:
+            cands.add(p)
+            p *= 2
+        return sorted(c for c in cands if c == extent or c % align == 0)
+
+    def _space_tile_candidates(self, node: PrimFuncNode):
+        shape = node.get_space_dim()
+        bits = node.get_dtype().bits
+        per_dim = []
+        for i, extent in enumerate(shape):
+            if i == len(shape) - 1:
+                # rows are padded to the EU width
+                per_dim.append(self._aligned_candidates(extent, self.arch.eu_num(bits)))
+            elif i == len(shape) - 2:
+                # the channel dim is spread over the NPUs
+                per_dim.append(self._aligned_candidates(extent, self.arch.npu_num))
+            else:
+                per_dim.append([c for c in (1, 2, 4, 8) if c <= extent])
+        return itertools.product(*per_dim)
+
+    def _reduce_step_candidates(self, node: PrimFuncNode):
+        if node.reduction_block is None:
+            return [{}]
+        steps = {}
+        for ax in node.raxis:
+            extent = int(ax.dom.extent)
+            steps[ax.var.name] = self._aligned_candidates(extent, self.arch.eu_num(32))
+        keys = list(steps.keys())
+        return [dict(zip(keys, values)) for values in itertools.product(*steps.values())]
+
+    def _local_bytes_per_npu(self, shape: List[int], bits: int) -> int:
+        """Bytes one NPU holds for a local tensor: rows on NPUs, row bytes EU aligned."""
+        if len(shape) == 0:
+            return 0
+        row_bytes = int(shape[-1]) * bits // 8
+        row_bytes = math.ceil(row_bytes / self.arch.eu_bytes) * self.arch.eu_bytes
+        channels = int(shape[-2]) if len(shape) >= 2 else 1
+        batch = int(np.prod(shape[:-2])) if len(shape) > 2 else 1
+        return batch * math.ceil(channels / self.arch.npu_num) * row_bytes
+
+    def _banks(self, nbytes: int) -> int:
+        # AddressAssign places every buffer at a bank boundary
+        return max(math.ceil(nbytes / self.arch.bank_size), 1)
+
+    def estimate(self, node: PrimFuncNode, tile, rstep: Dict[str, int],
+                 num_stages: int) -> Optional[TPUTileEstimate]:
+        """Return the modelled cost of ``tile``/``rstep``, or None if it does not fit."""
+        arch = self.arch
+        tile = [int(t) for t in tile]
+        est = TPUTileEstimate(tile, rstep, num_stages)
+        input_shapes = node.propagate_inputs(tile, rstep=rstep)
+
+        banks = 0
+        local = 0
+        in_bytes = 0
+        for shape, buffer in zip(input_shapes, node.input_buffers):
+            bits = node.get_buffer_dtype(buffer).bits
+            per_npu = self._local_bytes_per_npu(shape, bits)
+            banks += num_stages * self._banks(per_npu)
+            local += num_stages * per_npu
+            in_bytes += int(np.prod(shape)) * bits // 8
+        out_bits = node.get_dtype().bits
+        # reductions accumulate in a 32-bit local tile
+        acc_bits = max(out_bits, 32) if node.reduction_block is not None else out_bits
+        out_per_npu = self._local_bytes_per_npu(tile, acc_bits)
+        banks += self._banks(out_per_npu)
+        local += out_per_npu
+        if banks > arch.bank_num or local > arch.local_mem_per_npu:
+            return None
+        est.banks, est.local_mem_per_npu = banks, local
+
+        space = node.get_space_dim()
+        est.grid_size = int(np.prod([math.ceil(s / t) for s, t in zip(space, tile)]))
+        est.num_wave = math.ceil(est.grid_size / arch.compute_max_core)
+        est.steps = int(
+            np.prod([math.ceil(int(ax.dom.extent) / rstep[ax.var.name]) for ax in node.raxis]))
+
+        # padded elements are what the BDC actually processes
+        padded = list(tile)
+        padded[-1] = math.ceil(padded[-1] / arch.eu_num(out_bits)) * arch.eu_num(out_bits)
+        if len(padded) >= 2:
+            padded[-2] = math.ceil(padded[-2] / arch.npu_num) * arch.npu_num
+        bandwidth = arch.gdma_bandwidth * 1e3  # bytes per us
+        overhead = arch.cmd_overhead_us
+        est.dma_us = in_bytes / bandwidth + len(input_shapes) * overhead
+        est.store_us = int(np.prod(tile)) * out_bits // 8 / bandwidth + overhead
+        if node.reduction_block is not None and len(node.input_buffers) >= 2:
+            # contractions run on the matrix unit
+            in_dtype = str(node.get_buffer_dtype(node.input_buffers[0]))
+            macs = int(np.prod(padded)) * int(np.prod(list(rstep.values())))
+            est.compute_us = 2 * macs / (arch.matmul_tflops(in_dtype) * 1e6) + overhead
+        else:
+            est.compute_us = int(np.prod(padded)) / (arch.vector_gops(out_bits) * 1e3) + overhead
+
+        step_us = max(est.dma_us, est.compute_us) if num_stages > 1 else (est.dma_us +
+                                                                          est.compute_us)
+        if num_stages > 1:
+            # the first load and the last compute are not hidden
+            tile_us = est.dma_us + (est.steps - 1) * step_us + est.compute_us + est.store_us
+        else:
+            tile_us = est.steps * step_us + est.store_us
+        est.latency_us = est.num_wave * tile_us
+        return est
+
+    def _to_hint(self, node: PrimFuncNode, est: TPUTileEstimate) -> Hint:
+        hint = Hint()
+        hint.arch = self.arch
+        hint.block = est.tile
+        hint.thread = [1 for _ in est.tile]
+        hint.rstep = [est.rstep[ax.var.name] for ax in node.raxis]
+        hint.pipeline_stage = est.num_stages
+        hint.shared_scope = "local"
+        hint.opt_shapes = node.get_tag("opt_shapes")
+        hint.estimate = est
+        return hint
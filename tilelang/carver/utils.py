@@ -4,8 +4,8 @@
 from typing import List, Optional, Union
 from tvm import tir, IRModule
 from tvm.tir import PrimFunc
-from .arch import TileDevice
-from .roller.policy import TensorCorePolicy, DefaultPolicy
+from .arch import TileDevice, is_tpu_arch
+from .roller.policy import TensorCorePolicy, DefaultPolicy, TPUPolicy
 from .roller.hint import Hint
 from .roller.node import OutputNode
 from .matmul_analysis import get_tensorized_func_and_tags
@@ -45,6 +45,9 @@ def get_roller_hints_from_func(func_or_module: Union[tir.PrimFunc, IRModule],
     assert func is not None, "The function should not be None"
 
     roller_hints = None
+    if is_tpu_arch(arch):
+        # no tensorization on the TPU, tiles are ranked by the local memory model
+        return TPUPolicy.from_prim_func(func=func, arch=arch).emit_config(topk)
     if tensorcore_only:
         try:
             tensorized_func, tags = get_tensorized_func_and_tags(
@@ -79,6 +82,10 @@ def get_roller_hints_from_output_nodes(
         extra_tags: Optional[List[str]] = None) -> Optional[List[Hint]]:
     assert isinstance(output_nodes, list), "The input should be a list of functions."
 
+    if is_tpu_arch(arch):
+        policy = TPUPolicy.from_output_nodes(output_nodes, arch=arch, tags=None)
+        return policy.emit_config(topk)
+
     lints = []
     try:
         policy = TensorCorePolicy.from_output_nodes(output_nodes, arch=arch, tags=None)
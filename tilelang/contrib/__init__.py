@@ -3,3 +3,4 @@
 
 from .nvcc import compile_cuda  # noqa: F401
 from .hipcc import compile_hip  # noqa: F401
+from .rvv import compile_rvv  # noqa: F401
@@ -0,0 +1,399 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+"""Cross-compile RVV kernels and run them under qemu-user.
+
+Kernels generated with ``target="rvv"`` are compiled with a riscv64 toolchain
+together with a small driver that loads the parameters from a file, launches
+the kernel and writes the parameters back, then executed with
+``qemu-riscv64`` at a chosen VLEN. With the qemu ``libinsn`` plugin the run
+also reports the dynamic instruction count, so codegen changes can be measured
+on an x86 host.
+
+Environment variables:
+
+- ``TILELANG_RVV_CC``: the cross compiler (default: the first of
+  ``riscv64-linux-gnu-gcc`` / ``riscv64-unknown-linux-gnu-gcc`` on PATH).
+- ``TILELANG_RVV_QEMU``: the qemu-user binary (default ``qemu-riscv64``).
+- ``TILELANG_RVV_VLEN``: default VLEN in bits (default 128).
+- ``TILELANG_QEMU_PLUGIN``: path of ``libinsn.so`` for instruction counting.
+
+Kernels are built with ``-fopenmp`` so the block grid runs on every hart qemu
+provides; ``OMP_NUM_THREADS`` limits them at run time.
+
+On a riscv64 host ``compile_rvv_shared`` builds the kernel natively into a
+shared object instead, with the C entry ``tilelang_rvv_call(void **args, int
+num_args)`` that the JIT adapter calls in process through ctypes. The shared
+objects are cached under ``$TILELANG_CACHE_DIR/rvv`` by a hash of the source,
+compiler and flags, so a kernel is compiled once per machine.
+"""
+
+import hashlib
+import os
+import platform
+import re
+import shutil
+import subprocess
+import tempfile
+from dataclasses import dataclass
+from typing import List, Optional, Sequence
+
+import numpy as np
+
+from tilelang.env import TILELANG_CACHE_DIR, TILELANG_TEMPLATE_PATH
+
+# prepended to every generated kernel, which only emits the code itself
+RVV_HEADERS = """#include <riscv_vector.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include <stddef.h>
+#include <float.h>
+"""
+
+_CC_NAMES = ("riscv64-linux-gnu-gcc", "riscv64-unknown-linux-gnu-gcc")
+_PLUGIN_DIRS = ("/usr/lib/qemu/plugins", "/usr/local/lib/qemu/plugins",
+                "/usr/libexec/qemu/plugins")
+_INSNS_RE = re.compile(r"insns:\s*(\d+)")
+_TIME_RE = re.compile(r"tilelang_rvv_time_ns (\d+)")
+# the driver calls the kernel through this name when it is itself called main
+_RENAMED_MAIN = "tilelang_rvv_kernel"
+_NATIVE_CC_NAMES = ("gcc", "cc")
+
+
+def get_rvv_cc() -> Optional[str]:
+    """Return the riscv64 cross compiler, or None if none was found."""
+    env_cc = os.environ.get("TILELANG_RVV_CC")
+    if env_cc:
+        return env_cc
+    for name in _CC_NAMES:
+        path = shutil.which(name)
+        if path:
+            return path
+    return None
+
+
+def is_riscv_host() -> bool:
+    """Whether kernels can run natively, without qemu."""
+    return platform.machine() == "riscv64"
+
+
+def get_native_cc() -> Optional[str]:
+    """Return the compiler for in-process kernels on a riscv64 host, or None."""
+    if not is_riscv_host():
+        return None
+    cc = get_rvv_cc()
+    if cc is not None:
+        return cc
+    for name in _NATIVE_CC_NAMES:
+        path = shutil.which(name)
+        if path:
+            return path
+    return None
+
+
+def get_qemu() -> Optional[str]:
+    """Return the qemu-riscv64 user mode emulator, or None if none was found."""
+    return shutil.which(os.environ.get("TILELANG_RVV_QEMU", "qemu-riscv64"))
+
+
+def get_insn_plugin() -> Optional[str]:
+    """Return the qemu instruction counting plugin, or None if none was found."""
+    env_plugin = os.environ.get("TILELANG_QEMU_PLUGIN")
+    if env_plugin:
+        return env_plugin
+    for d in _PLUGIN_DIRS:
+        path = os.path.join(d, "libinsn.so")
+        if os.path.exists(path):
+            return path
+    return None
+
+
+def default_vlen() -> int:
+    return int(os.environ.get("TILELANG_RVV_VLEN", "128"))
+
+
+@dataclass
+class QemuResult:
+    """Outcome of one kernel run under qemu."""
+    outputs: List[np.ndarray]  # every parameter after the run, inputs included
+    time_ns: int  # emulated wall time of the launches, not hardware time
+    insns: Optional[int] = None  # dynamic instructions of the whole process
+    stdout: str = ""
+
+
+def _kernel_symbol(artifact) -> str:
+    symbols = [
+        str(gv.name_hint)
+        for gv, func in artifact.device_mod.functions.items()
+        if "global_symbol" in (func.attrs or {})
+    ]
+    assert len(symbols) == 1, f"expected one kernel, got {symbols}"
+    return symbols[0]
+
+
+def _driver_source(symbol: str, sizes: Sequence[int]) -> str:
+    n = len(sizes)
+    args = ", ".join(f"bufs[{i}]" for i in range(n))
+    return f"""#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+void {symbol}({", ".join(["void*"] * n)});
+
+static const size_t sizes[{n}] = {{{", ".join(str(s) for s in sizes)}}};
+
+/* usage: driver <params in> <params out> [repeats] */
+int main(int argc, char **argv) {{
+  void *bufs[{n}];
+  FILE *in = fopen(argv[1], "rb");
+  if (!in) return 2;
+  for (int i = 0; i < {n}; ++i) {{
+    bufs[i] = malloc(sizes[i]);
+    if (fread(bufs[i], 1, sizes[i], in) != sizes[i]) return 3;
+  }}
+  fclose(in);
+  int repeats = argc > 3 ? atoi(argv[3]) : 1;
+  struct timespec t0, t1;
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for (int r = 0; r < repeats; ++r) {{
+    {symbol}({args});
+  }}
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  printf("tilelang_rvv_time_ns %lld\\n",
+         (long long)(t1.tv_sec - t0.tv_sec) * 1000000000LL + (t1.tv_nsec - t0.tv_nsec));
+  FILE *out = fopen(argv[2], "wb");
+  if (!out) return 2;
+  for (int i = 0; i < {n}; ++i) {{
+    fwrite(bufs[i], 1, sizes[i], out);
+    free(bufs[i]);
+  }}
+  fclose(out);
+  return 0;
+}}
+"""
+
+
+def _entry_source(symbol: str, num_params: int) -> str:
+    args = ", ".join(f"args[{i}]" for i in range(num_params))
+    return f"""
+/* stable entry of the shared object, whatever the kernel is called */
+__attribute__((visibility("default"))) int tilelang_rvv_num_params(void) {{
+  return {num_params};
+}}
+
+__attribute__((visibility("default"))) int tilelang_rvv_call(void **args, int num_args) {{
+  if (num_args != {num_params}) return -1;
+  {symbol}({args});
+  return 0;
+}}
+"""
+
+
+def compile_rvv_shared(artifact,
+                       arch: str = "rv64gcv",
+                       abi: str = "lp64d",
+                       options: Optional[List[str]] = None,
+                       openmp: bool = True,
+                       cache_dir: Optional[str] = None) -> str:
+    """
+    Compile a lowered RVV kernel natively into a shared object with the entry
+    ``int tilelang_rvv_call(void **args, int num_args)``, one pointer per kernel
+    parameter; it returns 0, or -1 if ``num_args`` does not match.
+
+    The shared object is cached in ``cache_dir`` (default
+    ``$TILELANG_CACHE_DIR/rvv``) under a hash of the source, the compiler and
+    the flags, and reused by later calls and processes.
+
+    Returns
+    -------
+    str
+        The path of the shared object.
+    """
+    cc = get_native_cc()
+    if cc is None:
+        raise RuntimeError("In-process RVV kernels need a riscv64 host with a C compiler, "
+                           "set TILELANG_RVV_CC")
+    symbol = _kernel_symbol(artifact)
+    callee = _RENAMED_MAIN if symbol == "main" else symbol
+    flags = [f"-march={arch}", f"-mabi={abi}", "-shared", "-fPIC"] + (options or ["-O2"])
+    if openmp:
+        flags.append("-fopenmp")
+    flags += [f"-I{TILELANG_TEMPLATE_PATH}", "-DTILELANG_RVV_NO_MAIN"]
+    if symbol == "main":
+        flags.append(f"-Dmain={_RENAMED_MAIN}")
+    source = (RVV_HEADERS + artifact.kernel_source +
+              _entry_source(callee, len(artifact.params)))
+
+    cache_dir = cache_dir or os.path.join(TILELANG_CACHE_DIR, "rvv")
+    key = hashlib.sha256("\0".join([source, cc] + flags).encode()).hexdigest()
+    lib_path = os.path.join(cache_dir, f"{callee}_{key[:32]}.so")
+    if os.path.exists(lib_path):
+        return lib_path
+    os.makedirs(cache_dir, exist_ok=True)
+    with tempfile.TemporaryDirectory(dir=cache_dir) as tmp:
+        src_path = os.path.join(tmp, "kernel.c")
+        tmp_lib = os.path.join(tmp, "kernel.so")
+        with open(src_path, "w") as f:
+            f.write(source)
+        proc = subprocess.run([cc] + flags + [src_path, "-lm", "-o", tmp_lib],
+                              capture_output=True,
+                              text=True)
+        if proc.returncode != 0:
+            raise RuntimeError(f"Compiling the RVV kernel {symbol} failed:\n{proc.stderr}")
+        # a concurrent build of the same kernel produces the same file
+        os.replace(tmp_lib, lib_path)
+    return lib_path
+
+
+def compile_rvv(artifact,
+                output: str,
+                arch: str = "rv64gcv",
+                abi: str = "lp64d",
+                options: Optional[List[str]] = None,
+                openmp: bool = True) -> str:
+    """
+    Cross-compile a lowered RVV kernel and its driver into a static executable.
+
+    Parameters
+    ----------
+    artifact : CompiledArtifact
+        The result of ``tilelang.lower(func, target="rvv")``.
+    output : str
+        Path of the executable.
+    arch, abi : str
+        ``-march``/``-mabi`` of the target, e.g. ``rv64gcv_zvfh`` for fp16 vectors.
+    options : list of str, optional
+        Extra compiler flags, e.g. ``["-O3"]``; ``-O2`` is used by default.
+    openmp : bool
+        Link the OpenMP runtime so the block grid is spread over the harts;
+        without it the grid runs serially.
+
+    Returns
+    -------
+    str
+        ``output``.
+    """
+    cc = get_rvv_cc()
+    if cc is None:
+        raise RuntimeError("No riscv64 cross compiler found, set TILELANG_RVV_CC")
+    symbol = _kernel_symbol(artifact)
+    callee = _RENAMED_MAIN if symbol == "main" else symbol
+    sizes = []
+    for param in artifact.params:
+        numel = int(np.prod([int(s) for s in param.shape])) if param.shape else 1
+        sizes.append(numel * param.dtype.itemsize)
+    flags = [f"-march={arch}", f"-mabi={abi}", "-static"] + (options or ["-O2"])
+    if openmp:
+        flags.append("-fopenmp")
+    # generated kernels include tl_templates/rvv/*.h
+    flags.append(f"-I{TILELANG_TEMPLATE_PATH}")
+
+    work_dir = os.path.dirname(os.path.abspath(output))
+    kernel_c = os.path.join(work_dir, f"{callee}_kernel.c")
+    driver_c = os.path.join(work_dir, f"{callee}_driver.c")
+    with open(kernel_c, "w") as f:
+        f.write(RVV_HEADERS + artifact.kernel_source)
+    with open(driver_c, "w") as f:
+        f.write(_driver_source(callee, sizes))
+    kernel_flags = ["-DTILELANG_RVV_NO_MAIN"]
+    if symbol == "main":
+        kernel_flags.append(f"-Dmain={_RENAMED_MAIN}")
+    kernel_o = kernel_c[:-2] + ".o"
+    subprocess.run([cc] + flags + kernel_flags + ["-c", kernel_c, "-o", kernel_o],
+                   check=True,
+                   capture_output=True,
+                   text=True)
+    subprocess.run([cc] + flags + [driver_c, kernel_o, "-lm", "-o", output],
+                   check=True,
+                   capture_output=True,
+                   text=True)
+    return output
+
+
+def run_qemu(executable: str,
+             args: Sequence[str] = (),
+             vlen: Optional[int] = None,
+             count_insns: bool = False,
+             timeout: Optional[float] = None) -> QemuResult:
+    """Run ``executable`` under qemu-riscv64 with the V extension at ``vlen`` bits."""
+    qemu = get_qemu()
+    if qemu is None:
+        raise RuntimeError("qemu-riscv64 not found, set TILELANG_RVV_QEMU")
+    vlen = vlen or default_vlen()
+    cmd = [qemu, "-cpu", f"rv64,v=true,vlen={vlen},elen=64,zvfh=true"]
+    log_path = None
+    if count_insns:
+        plugin = get_insn_plugin()
+        if plugin is None:
+            raise RuntimeError("qemu libinsn.so plugin not found, set TILELANG_QEMU_PLUGIN")
+        log_fd, log_path = tempfile.mkstemp(suffix=".log")
+        os.close(log_fd)
+        cmd += ["-plugin", f"{plugin},inline=on", "-d", "plugin", "-D", log_path]
+    proc = subprocess.run(cmd + [executable] + list(args),
+                          capture_output=True,
+                          text=True,
+                          timeout=timeout)
+    if proc.returncode != 0:
+        raise RuntimeError(f"{executable} failed under qemu ({proc.returncode}):\n"
+                           f"{proc.stdout}\n{proc.stderr}")
+    insns = None
+    if log_path is not None:
+        with open(log_path) as f:
+            match = _INSNS_RE.search(f.read())
+        os.unlink(log_path)
+        insns = int(match.group(1)) if match else None
+    match = _TIME_RE.search(proc.stdout)
+    return QemuResult([], int(match.group(1)) if match else 0, insns, proc.stdout)
+
+
+def run_rvv_kernel(artifact,
+                   inputs: Sequence[np.ndarray],
+                   vlen: Optional[int] = None,
+                   repeats: int = 1,
+                   count_insns: bool = False,
+                   arch: str = "rv64gcv",
+                   options: Optional[List[str]] = None,
+                   work_dir: Optional[str] = None) -> QemuResult:
+    """
+    Compile ``artifact``, run it ``repeats`` times on ``inputs`` and read back all
+    parameters.
+
+    ``inputs`` holds one array per kernel parameter (outputs too, they are passed
+    in as initial contents); ``QemuResult.outputs`` has the same layout.
+    """
+    params = artifact.params
+    assert len(inputs) == len(params), f"expected {len(params)} arrays, got {len(inputs)}"
+    arrays = [np.ascontiguousarray(a) for a in inputs]
+    with tempfile.TemporaryDirectory(dir=work_dir) as tmp:
+        exe = compile_rvv(artifact, os.path.join(tmp, "kernel"), arch=arch, options=options)
+        in_path = os.path.join(tmp, "params.in")
+        out_path = os.path.join(tmp, "params.out")
+        with open(in_path, "wb") as f:
+            for a in arrays:
+                f.write(a.tobytes())
+        result = run_qemu(exe, [in_path, out_path, str(repeats)], vlen, count_insns)
+        with open(out_path, "rb") as f:
+            blob = f.read()
+    offset = 0
+    for a in arrays:
+        result.outputs.append(
+            np.frombuffer(blob, dtype=a.dtype, count=a.size, offset=offset).reshape(a.shape))
+        offset += a.nbytes
+    return result
+
+
+def insns_per_launch(artifact,
+                     inputs: Sequence[np.ndarray],
+                     vlen: Optional[int] = None,
+                     repeats: int = 4,
+                     **kwargs) -> float:
+    """
+    Dynamic instructions of one kernel launch: the difference between ``repeats``
+    launches and none, so the driver's file I/O and allocation cancel out.
+    """
+    base = run_rvv_kernel(artifact, inputs, vlen, repeats=0, count_insns=True, **kwargs)
+    full = run_rvv_kernel(artifact, inputs, vlen, repeats=repeats, count_insns=True, **kwargs)
+    return (full.insns - base.insns) / repeats
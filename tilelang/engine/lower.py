@@ -12,7 +12,7 @@ from tvm.ir import CallingConv
 from tvm.target import Target
 from tilelang.contrib import hipcc, nvcc
 from tilelang.engine.param import KernelParam, CompiledArtifact
-from tilelang.utils.target import determine_target
+from tilelang.utils.target import determine_target, parse_target_options
 from tilelang.engine.phase import (
     LowerAndLegalize,
     OptimizeForTarget,
@@ -196,6 +196,51 @@ def device_codegen_without_compile(device_mod: tvm.IRModule, target: Target) ->
     return device_mod
 
 
+def reject_tile_gemm(mod: tvm.IRModule, backend: str, replacement: str):
+    """
+    Raise if the module uses T.gemm. The tpu and rvv backends run the TVM passes
+    for a dummy llvm target, which would lower it to the host's tl::cpu::gemm_ss.
+    """
+    found = []
+
+    def visit(node):
+        if isinstance(node, tir.Call) and isinstance(node.op, tvm.ir.Op) and \
+                node.op.name == "tl.gemm":
+            found.append(node)
+
+    for _, func in mod.functions.items():
+        if isinstance(func, tir.PrimFunc):
+            tir.stmt_functor.post_order_visit(func.body, visit)
+    if found:
+        raise ValueError(f"T.gemm is not supported by the {backend} backend, use {replacement}")
+
+
+def rvv_pass_configs(target: Union[str, Target]) -> dict:
+    """
+    Pass configs the RVV codegen reads from the target string.
+
+    ``"rvv -vlen=256"`` promises every target core has VLEN >= 256, so LMUL and
+    the GEMM tiles are sized for 256-bit registers (``tl.rvv_min_vlen``, 128 by
+    default). The kernels stay correct on any VLEN, only the tuning assumes it.
+
+    ``"rvv -threads=8 -schedule=dynamic"`` spreads the block grid over 8 harts
+    (``tl.rvv_num_threads``, 0 for all harts by default, 1 for serial code)
+    with a dynamic instead of the default static OpenMP schedule
+    (``tl.rvv_schedule``).
+    """
+    if not isinstance(target, str):
+        return {}
+    _, options = parse_target_options(target)
+    configs = {}
+    if "vlen" in options:
+        configs["tl.rvv_min_vlen"] = int(options["vlen"])
+    if "threads" in options:
+        configs["tl.rvv_num_threads"] = int(options["threads"])
+    if "schedule" in options:
+        configs["tl.rvv_schedule"] = options["schedule"]
+    return configs
+
+
 def lower(
     func_or_mod: Union[tir.PrimFunc, tvm.IRModule],
     target: Union[str, Target] = "auto",
@@ -220,6 +265,15 @@ def lower(
     if isinstance(target, str):
         target = determine_target(target)
 
+    is_tpu = (isinstance(target, str) and target == "tpu") or (hasattr(target, 'kind') and
+                                                              target.kind.name == "tpu")
+    is_rvv = (isinstance(target, str) and parse_target_options(target)[0] == "rvv") or (hasattr(
+        target, 'kind') and target.kind.name == "rvv")
+    if is_tpu:
+        reject_tile_gemm(mod, "tpu", "T.ppl_gemm")
+    elif is_rvv:
+        reject_tile_gemm(mod, "rvv", "T.rvv_gemm")
+
     # For TPU, use a dummy CPU target for TVM transforms but generate TPU code
     dummy_target = tvm.target.Target("llvm", tvm.target.Target("llvm"))
     
@@ -227,16 +281,20 @@ def lower(
     mod = LowerAndLegalize(mod, dummy_target)
 
     # Phase 2: Optimize the IR for the target  
-    mod = OptimizeForTarget(mod, dummy_target)
+    mod = OptimizeForTarget(mod, dummy_target, is_tpu=is_tpu)
     
     # Special handling for TPU target which doesn't use TVM's target system
     
-    if (isinstance(target, str) and target == "tpu") or (hasattr(target, 'kind') and target.kind.name == "tpu"):
+    if is_tpu:
         # Directly call TPU codegen and return source code
         device_source = tvm._ffi.get_global_func("target.build.tilelang_ppl")(mod)
         return CompiledArtifact(None, mod, params, device_source)
-    elif (isinstance(target, str) and target == "rvv") or (hasattr(target, 'kind') and target.kind.name == "rvv"):
-        device_source = tvm._ffi.get_global_func("target.build.tilelang_rvv")(mod)
+    elif is_rvv:
+        ctx = tvm.transform.PassContext.current()
+        configs = dict(ctx.config)
+        configs.update(rvv_pass_configs(target))
+        with tvm.transform.PassContext(opt_level=ctx.opt_level, config=configs):
+            device_source = tvm._ffi.get_global_func("target.build.tilelang_rvv")(mod)
         return CompiledArtifact(None, mod, params, device_source)
 
     target_host = canon_target_host(target, target_host)
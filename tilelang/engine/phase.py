@@ -37,7 +37,9 @@ def LowerAndLegalize(mod: IRModule, target: Target) -> IRModule:
     return mod
 
 
-def OptimizeForTarget(mod: IRModule, target: Target) -> IRModule:
+def OptimizeForTarget(mod: IRModule, target: Target, is_tpu: bool = False) -> IRModule:
+    # TPU modules are optimized with a dummy llvm target, is_tpu enables the
+    # passes only the PPL codegen needs
     # which may be introduced by the LegalizeSafeMemoryAccess
     if target.arch == "sm_90":
         mod = tilelang.transform.IfStmtBinding()(mod)
@@ -50,10 +52,19 @@ def OptimizeForTarget(mod: IRModule, target: Target) -> IRModule:
         mod = tilelang.transform.InjectFenceProxy()(mod)
     else:
         mod = tilelang.transform.IfStmtBinding()(mod)
+        # fuse ppl.* elementwise chains before the pipeline multi-versions
+        # their temporaries
+        mod = tilelang.transform.FusePPLElementwise()(mod)
         mod = tir.transform.PlanAndUpdateBufferAllocationLocation()(mod)
         mod = tilelang.transform.PipelinePlanning()(mod)
         mod = tilelang.transform.InjectSoftwarePipeline()(mod)
         mod = tilelang.transform.MergeIfStmt()(mod)
+        if is_tpu:
+            # turn the per-iteration buffer version selection into static
+            # versions, the unrolled copies rebind the same let vars so re-SSA
+            # them
+            mod = tilelang.transform.UnrollPipelineVersions()(mod)
+            mod = tir.transform.ConvertSSA()(mod)
 
     # TODO(lei): may need a pass to fuse the if-then-else in the
     # pipeline loop when we meet dynamic branch.
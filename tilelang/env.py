@@ -49,6 +49,11 @@ TILELANG_CACHE_DIR: str = os.environ.get("TILELANG_CACHE_DIR",
 # Auto-clear cache if environment variable is set
 TILELANG_CLEAR_CACHE = os.environ.get("TILELANG_CLEAR_CACHE", "0")
 
+# ISA flags of the ctypes CPU build, e.g. "-march=x86-64-v3" for kernels shared
+# between hosts. Unset builds for the host with -march=native (-mcpu=native on
+# arm64).
+TILELANG_CPU_ARCH_FLAGS: str = os.environ.get("TILELANG_CPU_ARCH_FLAGS", None)
+
 # SETUP ENVIRONMENT VARIABLES
 CUTLASS_NOT_FOUND_MESSAGE = ("CUTLASS is not installed or found in the expected path")
 ", which may lead to compilation bugs when utilize tilelang backend."
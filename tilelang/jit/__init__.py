@@ -14,7 +14,7 @@ from tvm.target import Target
 
 from tilelang.jit.adapter import BaseKernelAdapter
 from tilelang.jit.kernel import JITKernel
-from tilelang.utils.target import determine_target, AVALIABLE_TARGETS
+from tilelang.utils.target import determine_target, parse_target_options, AVALIABLE_TARGETS
 from tilelang.cache import cached
 from logging import getLogger
 import tilelang
@@ -67,9 +67,9 @@ def jit(
 
     # If the target is specified as a string, ensure it is valid and convert to a TVM Target.
     if isinstance(target, str):
-        assert target in AVALIABLE_TARGETS, f"Invalid target: {target}"
+        assert parse_target_options(target)[0] in AVALIABLE_TARGETS, f"Invalid target: {target}"
         # Special handling for TPU - don't convert to TVM Target
-        if target not in ["tpu", "rvv"]:
+        if parse_target_options(target)[0] not in ["tpu", "rvv"]:
             target = determine_target(target)
             target = Target(target)
 
@@ -95,7 +95,8 @@ def jit(
         # Special handling for TPU target
         if (isinstance(target, str) and target == "tpu") or (hasattr(target, 'kind') and hasattr(target.kind, 'name') and target.kind.name == "tpu"):
             # Compile using TPU backend
-            compiled_artifact = tilelang.lower(tilelang_func, target="tpu")
+            with tvm.transform.PassContext(config=pass_config_kwargs.get("pass_configs") or {}):
+                compiled_artifact = tilelang.lower(tilelang_func, target="tpu")
             # Extract function name from tilelang_func
             fn_name = getattr(tilelang_func, 'attrs', {}).get('global_symbol', None)
             if fn_name is None:
@@ -104,9 +105,10 @@ def jit(
             from tilelang.jit.adapter.tpu import TPUKernelAdapter
             return TPUKernelAdapter(compiled_artifact, out_idx or [], fn_name=fn_name)
         
-        elif (isinstance(target, str) and target == "rvv") or (hasattr(target, 'kind') and hasattr(target.kind, 'name') and target.kind.name == "rvv"):
-            # 使用 RVV 后端编译
-            compiled_artifact = tilelang.lower(tilelang_func, target="rvv")
+        elif (isinstance(target, str) and parse_target_options(target)[0] == "rvv") or (hasattr(target, 'kind') and hasattr(target.kind, 'name') and target.kind.name == "rvv"):
+            # 使用 RVV 后端编译, "rvv -vlen=256" 指定最小 VLEN
+            with tvm.transform.PassContext(config=pass_config_kwargs.get("pass_configs") or {}):
+                compiled_artifact = tilelang.lower(tilelang_func, target=target)
             # 从 tilelang_func 提取函数名
             fn_name = getattr(tilelang_func, 'attrs', {}).get('global_symbol', None)
             if fn_name is None:
@@ -150,7 +152,9 @@ def compile(
     # Special handling for TPU target
     if (isinstance(target, str) and target == "tpu"):
         # For TPU, create a simple JITKernel-like wrapper
-        compiled_artifact = tilelang.lower(func, target="tpu")
+        # pass_configs such as tl.ppl_profile are read by the PPL codegen
+        with tvm.transform.PassContext(config=pass_configs or {}):
+            compiled_artifact = tilelang.lower(func, target="tpu")
         # Extract function name
         fn_name = getattr(func, 'attrs', {}).get('global_symbol', None)
         if fn_name is None:
@@ -181,9 +185,11 @@ def compile(
         
         return TPUJITKernel(adapter)
     
-    elif (isinstance(target, str) and target == "rvv"):
+    elif (isinstance(target, str) and parse_target_options(target)[0] == "rvv"):
     # 对于 RVV，创建一个简单的类似 JITKernel 的包装器
-        compiled_artifact = tilelang.lower(func, target="rvv")
+        # pass_configs such as tl.rvv_min_vlen are read by the RVV codegen
+        with tvm.transform.PassContext(config=pass_configs or {}):
+            compiled_artifact = tilelang.lower(func, target=target)
         # 提取函数名
         fn_name = getattr(func, 'attrs', {}).get('global_symbol', None)
         if fn_name is None:
@@ -6,15 +6,48 @@ from tilelang import tvm as tvm
 from tilelang.contrib.nvcc import get_target_compute_version
 from tvm.target import Target
 import ctypes
+import functools
+import hashlib
 import os
+import platform
+import shlex
 import tempfile
 import subprocess
 import logging
-from tilelang.env import TILELANG_TEMPLATE_PATH, CUTLASS_INCLUDE_DIR
+from typing import List
+from tilelang.env import TILELANG_TEMPLATE_PATH, CUTLASS_INCLUDE_DIR, TILELANG_CPU_ARCH_FLAGS
 
 logger = logging.getLogger(__name__)
 
 
+def cpu_arch_flags() -> List[str]:
+    """ISA flags of the CPU build, TILELANG_CPU_ARCH_FLAGS or the host's native ISA."""
+    if TILELANG_CPU_ARCH_FLAGS:
+        return shlex.split(TILELANG_CPU_ARCH_FLAGS)
+    # tl::cpu::gemm_ss vectorizes for the widest SIMD the flags allow
+    return ["-mcpu=native" if platform.machine() in ("aarch64", "arm64") else "-march=native"]
+
+
+@functools.lru_cache(maxsize=None)
+def host_isa() -> str:
+    """The machine and the ISA extensions the CPU reports, what -march=native builds for."""
+    try:
+        with open("/proc/cpuinfo") as f:
+            for line in f:
+                if line.split(":")[0].strip() in ("flags", "Features", "isa"):
+                    return platform.machine() + ":" + hashlib.sha256(
+                        line.encode()).hexdigest()[:16]
+    except OSError:
+        pass
+    return platform.machine() + ":" + platform.processor()
+
+
+def cpu_arch_key() -> str:
+    """What a cached CPU kernel depends on: the flags, and the host for a native build."""
+    flags = " ".join(cpu_arch_flags())
+    return flags + " " + host_isa() if "native" in flags else flags
+
+
 class LibraryGenerator(object):
     srcpath: Optional[str] = None
     libpath: Optional[str] = None
@@ -73,7 +106,8 @@ class LibraryGenerator(object):
             src = tempfile.NamedTemporaryFile(mode="w", suffix=".cpp", delete=False)
             libpath = src.name.replace(".cpp", ".so")
 
-            command = [get_cplus_compiler(), "-std=c++17", "-fPIC", "-shared", src.name]
+            command = [get_cplus_compiler(), "-std=c++17", "-O3", *cpu_arch_flags()]
+            command += ["-fPIC", "-shared", src.name]
             with_tl = False
             command += [
                 "-I" + TILELANG_TEMPLATE_PATH,
@@ -39,6 +39,7 @@ from .allocate import (
     alloc_shared,  # noqa: F401
     alloc_fragment,  # noqa: F401
     alloc_var,  # noqa: F401
+    alloc_l2,  # noqa: F401
 )
 from .copy import copy, c2d_im2col  # noqa: F401
 from .gemm import GemmWarpPolicy, gemm  # noqa: F401
@@ -59,7 +60,16 @@ from .customize import (
     reshape,  # noqa: F401
     view,  # noqa: F401
     ppl_gemm,  # noqa: F401
+    ppl_grouped_gemm,  # noqa: F401
     ppl_copy,  # noqa: F401
+    ppl_transpose,  # noqa: F401
+    ppl_stage_l2,  # noqa: F401
+    ppl_all_reduce,  # noqa: F401
+    ppl_all_gather,  # noqa: F401
+    ppl_reduce_scatter,  # noqa: F401
+    ppl_conv2d,  # noqa: F401
+    ppl_quantize,  # noqa: F401
+    ppl_dequantize,  # noqa: F401
     ppl_fill,  # noqa: F401
     ppl_add,  # noqa: F401
     ppl_div,  # noqa: F401
@@ -77,7 +87,6 @@ from .customize import (
     rvv_fill,  # noqa: F401
     rvv_add,  # noqa: F401
     rvv_div,  # noqa: F401
-    rvv_exp2,  # noqa: F401 # noqa: F401
     rvv_mul,  # noqa: F401 
     rvv_mul_C,  # noqa: F401
     rvv_reduce_max,  # noqa: F401
@@ -85,6 +94,13 @@ from .customize import (
     rvv_subtract,  # noqa: F401
     rvv_embedding,  # noqa: F401
     rvv_rsqrt,  # noqa: F401
+    rvv_exp,  # noqa: F401
+    rvv_exp2,  # noqa: F401
+    rvv_exp_base2,  # noqa: F401
+    rvv_log,  # noqa: F401
+    rvv_tanh,  # noqa: F401
+    rvv_sigmoid,  # noqa: F401
+    rvv_gelu,  # noqa: F401
     rvv_add_C,  # noqa: F401
 )
 from .builtin import *  # noqa: F401
@@ -11,6 +11,7 @@ Available allocation functions:
     - alloc_local: Allocates local memory buffers for thread-private storage
     - alloc_fragment: Allocates fragment memory buffers for specialized operations
     - alloc_var: Allocates single-element variable buffers
+    - alloc_l2: Allocates TPU L2 SRAM buffers shared by all cores
 
 Each function takes shape and dtype parameters and returns a TVM buffer object
 with the appropriate memory scope.
@@ -72,3 +73,17 @@ def alloc_var(dtype, scope="local.var"):
         T.Buffer: A TVM buffer object allocated as a single-element variable
     """
     return T.alloc_buffer([1], dtype, scope=scope)
+
+
+def alloc_l2(shape, dtype, scope="shared.l2"):
+    """Allocate a buffer in the TPU L2 SRAM, shared by all cores of the chip.
+
+    Args:
+        shape (tuple): The shape of the buffer to allocate
+        dtype (str): The data type of the buffer (e.g., 'float16', 'int8')
+        scope (str, optional): The memory scope, "shared.l2" or "global.l2". Defaults to "shared.l2"
+
+    Returns:
+        T.Buffer: A TVM buffer object allocated in L2 SRAM
+    """
+    return T.alloc_buffer(shape, dtype, scope=scope)
@@ -6,6 +6,7 @@ import tilelang.language as T
 from tvm.tir import PrimExpr, Buffer, BufferRegion, BufferLoad
 from typing import List, Union
 from .copy import buffer_to_tile_region, buffer_region_to_tile_region, buffer_load_to_tile_region
+from tilelang.utils import deprecated
 
 
 def atomic_add(dst: Buffer, value: PrimExpr) -> PrimExpr:
@@ -97,22 +98,135 @@ def view(src: Buffer,
     return T.Buffer(shape, dtype, src.data)
 
 
-def ppl_gemm(A, B, C, transpose_A=False, transpose_B=False):
+@T.macro
+def ppl_gemm_dequant(Aptr, Bptr, Cptr, transpose_A, transpose_B, M, N, K, quantptr, b_shape,
+                     group_size, b_bits):
+    with T.block("gemm_dequant"):
+        b_scratch = T.alloc_shared(b_shape, "float16")
+        scratchptr = b_scratch.access_ptr("rw")
+        T.call_extern("handle", "ppl.gemm", Aptr, Bptr, Cptr, transpose_A, transpose_B, M, N, K,
+                      quantptr, scratchptr, group_size, b_bits)
+
+
+def ppl_gemm(A,
+             B,
+             C,
+             transpose_A=False,
+             transpose_B=False,
+             b_quant=None,
+             group_size=128,
+             b_bits=8):
+    """C += A @ B on the BDC matrix unit.
+
+    With ``b_quant`` B is a weight-only quantized tile that is group
+    dequantized to fp16 right before the matmul (see ``ppl_dequantize``); for
+    ``b_bits=4`` it holds two int4 values per byte along its last dim, so only
+    a quarter of the fp16 bytes is loaded from DDR.
+    """
     Aptr = A.access_ptr("r")
     Bptr = B.access_ptr("r")
     Cptr = C.access_ptr("rw")
     M = C.shape[0]
     N = C.shape[1]
     K = A.shape[0] if transpose_A else A.shape[1]
-    K_B = B.shape[1] if transpose_B else B.shape[0]
+    b_shape = list(B.shape)
+    if b_quant is not None:
+        b_shape[-1] = b_shape[-1] * 8 // b_bits
+    K_B = b_shape[1] if transpose_B else b_shape[0]
     assert K == K_B, "gemm K shape check failed"
+    if b_quant is not None:
+        return ppl_gemm_dequant(Aptr, Bptr, Cptr, transpose_A, transpose_B, M, N, K,
+                                b_quant.access_ptr("r"), b_shape, group_size, b_bits)
     return T.call_extern("handle", "ppl.gemm", Aptr, Bptr, Cptr, transpose_A, transpose_B, M, N, K)
 
 
+@T.macro
+def ppl_grouped_gemm_safe(Aptr, Bptr, Cptr, offsetsptr, num_experts, N, K, block_M, block_N,
+                          block_K, dtype):
+    with T.block("grouped_gemm"):
+        A_0 = T.alloc_shared((block_M, block_K), dtype)
+        A_1 = T.alloc_shared((block_M, block_K), dtype)
+        B_0 = T.alloc_shared((block_K, block_N), dtype)
+        B_1 = T.alloc_shared((block_K, block_N), dtype)
+        C_0 = T.alloc_shared((block_M, block_N), "float32")
+        C_1 = T.alloc_shared((block_M, block_N), "float32")
+        T.call_extern("handle", "ppl.grouped_gemm", Aptr, Bptr, Cptr, offsetsptr,
+                      A_0.access_ptr("w"), A_1.access_ptr("w"), B_0.access_ptr("w"),
+                      B_1.access_ptr("w"), C_0.access_ptr("rw"), C_1.access_ptr("rw"),
+                      num_experts, N, K, block_M, block_N, block_K)
+
+
+def ppl_grouped_gemm(A, B, C, offsets, block_M, block_N, block_K):
+    """Grouped (MoE) GEMM: ``C[o[e]:o[e+1]] = A[o[e]:o[e+1]] @ B[e]`` for every expert.
+
+    ``A`` is [total_M, K], ``B`` is [num_experts, K, N], ``C`` is the float32
+    [total_M, N] output and ``offsets`` the int32 [num_experts + 1] row offsets
+    of the experts, read on device so the routing can change between calls.
+    The whole grouped GEMM runs in one kernel: its (expert, tile) pairs are
+    dealt out to the TPU cores and each core double-buffers its loads, so the
+    next expert's weights stream in while the current tile computes. Launch it
+    from a ``T.Kernel(1, is_cpu=True)`` body.
+    """
+    num_experts, K, N = (int(x) for x in B.shape)
+    assert int(A.shape[1]) == K, "grouped gemm K shape check failed"
+    assert int(C.shape[1]) == N and int(C.shape[0]) == int(A.shape[0])
+    assert int(offsets.shape[0]) == num_experts + 1, "offsets must have num_experts + 1 entries"
+    return ppl_grouped_gemm_safe(
+        A.access_ptr("r"), B.access_ptr("r"), C.access_ptr("w"), offsets.access_ptr("r"),
+        num_experts, N, K, block_M, block_N, block_K, A.dtype)
+
+
+def ppl_quantize(out, inp, scale=1.0, zero_point=0.0, quant=None):
+    """Quantize a local tile: ``out = round(inp * scale + zero_point)``.
+
+    Per tensor with scalar ``scale``/``zero_point``, or per channel (row of a
+    2D tile) with ``quant`` holding the (scale, zero point) pair of every
+    channel as the BDC expects it.
+    """
+    outptr = out.access_ptr("w")
+    inpptr = inp.access_ptr("r")
+    quantptr = quant.access_ptr("r") if quant is not None else 0
+    return T.call_extern("handle", "ppl.quantize", outptr, inpptr, quantptr, float(scale),
+                         float(zero_point))
+
+
+def ppl_dequantize(out, inp, scale=1.0, zero_point=0.0, quant=None, group_size=0, src_bits=0):
+    """Dequantize a local tile: ``out = (inp - zero_point) * scale``.
+
+    - per tensor: scalar ``scale``/``zero_point``, ``out`` is float32;
+    - per channel: ``quant`` holds one (scale, zero point) pair per channel,
+      ``out`` is float32;
+    - group-wise: ``group_size`` > 0, ``quant`` holds a pair per group of
+      ``group_size`` elements along the last dim, ``out`` is float16/bfloat16.
+
+    ``src_bits=4`` reads ``inp`` (int8/uint8) as packed int4, two per byte.
+    """
+    if src_bits == 4:
+        assert int(inp.shape[-1]) * 2 == int(out.shape[-1]), "packed int4 shape mismatch"
+    if group_size > 0:
+        assert quant is not None, "group-wise dequantization needs a quant tile"
+        assert int(out.shape[-1]) % group_size == 0, "last dim must be a multiple of group_size"
+    outptr = out.access_ptr("w")
+    inpptr = inp.access_ptr("r")
+    quantptr = quant.access_ptr("r") if quant is not None else 0
+    return T.call_extern("handle", "ppl.dequantize", outptr, inpptr, quantptr, float(scale),
+                         float(zero_point), group_size, src_bits)
+
+
 def ppl_copy(
     src,
     dst,
+    pad_value=None,
 ):
+    """Copy a tile between global and local memory.
+
+    With ``pad_value`` the copy is a halo load for convolutions: ``src`` is a
+    4D global window that may start before or run past the image border (e.g.
+    ``x[n, c, oh * sh - pad_t, ow * sw - pad_l]`` of the tile's input extent),
+    only the part inside the tensor is fetched and the rest of ``dst`` is
+    filled with ``pad_value``. Neighbouring tiles simply use overlapping
+    windows.
+    """
 
     def get_extent(data):
         if isinstance(data, Buffer):
@@ -130,7 +244,11 @@ def ppl_copy(
 
     src_extent = list(src_extent) if src_extent else [1] * len(dst_extent)
     dst_extent = list(dst_extent) if dst_extent else [1] * len(src_extent)
-    extent = max(src_extent, dst_extent)
+    # only an element access takes the extent of the other side, slices may
+    # have runtime extents that do not compare
+    extent = None
+    if isinstance(src, BufferLoad) or isinstance(dst, BufferLoad):
+        extent = max(src_extent, dst_extent)
 
     def _to_region(data, access_type):
         if isinstance(data, Buffer):
@@ -144,9 +262,165 @@ def ppl_copy(
     dst = _to_region(dst, "w")
     print(src)
     print(dst)
+    if pad_value is not None:
+        return T.call_extern("handle", "ppl.copy", src, dst, float(pad_value))
     return T.call_extern("handle", "ppl.copy", src, dst)
 
 
+def _pair(value):
+    return (value, value) if isinstance(value, int) else tuple(value)
+
+
+@T.macro
+def ppl_conv2d_requant(outptr, inpptr, weightptr, biasptr, requantptr, acc_shape, params):
+    with T.block("conv2d"):
+        acc = T.alloc_shared(acc_shape, "int32")
+        accptr = acc.access_ptr("rw")
+        T.call_extern("handle", "ppl.conv2d", outptr, inpptr, weightptr, biasptr, requantptr,
+                      accptr, *params)
+
+
+def ppl_conv2d(out,
+               inp,
+               weight,
+               kernel_size,
+               stride=1,
+               padding=0,
+               dilation=1,
+               bias=None,
+               depthwise=False,
+               requant=None,
+               rshift=0):
+    """2D convolution of a local NCHW tile on the BDC.
+
+    ``inp`` is [N, C, H, W] and ``out`` is [N, OC, OH, OW]; ``weight`` and
+    ``bias`` must already be in the BDC conv layout. fp16/bf16/fp32 inputs
+    accumulate in fp32. int8 inputs use the symmetric int8 conv with a right
+    shift of ``rshift``; with ``requant`` (the per-channel multiplier/shift/zp
+    tile) the conv accumulates into an int32 tile that is then requantized
+    into ``out``. ``padding`` is an int, (h, w) or (top, bottom, left, right).
+    """
+    kh, kw = _pair(kernel_size)
+    sh, sw = _pair(stride)
+    dh, dw = _pair(dilation)
+    if isinstance(padding, int):
+        padding = (padding,) * 4
+    elif len(padding) == 2:
+        padding = (padding[0], padding[0], padding[1], padding[1])
+    pad_t, pad_b, pad_l, pad_r = padding
+
+    assert len(inp.shape) == 4 and len(out.shape) == 4, "ppl_conv2d expects NCHW tiles"
+    n, c, h, w = inp.shape
+    oh = (h + pad_t + pad_b - dh * (kh - 1) - 1) // sh + 1
+    ow = (w + pad_l + pad_r - dw * (kw - 1) - 1) // sw + 1
+    assert int(out.shape[0]) == int(n) and int(out.shape[2]) == int(oh) and int(
+        out.shape[3]) == int(ow), f"ppl_conv2d output shape mismatch: expect [{n}, *, {oh}, {ow}]"
+    if depthwise:
+        assert int(out.shape[1]) == int(c), "depthwise conv keeps the channel count"
+
+    outptr = out.access_ptr("w")
+    inpptr = inp.access_ptr("r")
+    weightptr = weight.access_ptr("r")
+    biasptr = bias.access_ptr("r") if bias is not None else 0
+    params = [kh, kw, sh, sw, pad_t, pad_b, pad_l, pad_r, dh, dw, bool(depthwise), rshift]
+    if requant is not None:
+        assert "int8" in str(inp.dtype), "per-channel requant needs int8 inputs"
+        return ppl_conv2d_requant(outptr, inpptr, weightptr, biasptr, requant.access_ptr("r"),
+                                  out.shape, params)
+    return T.call_extern("handle", "ppl.conv2d", outptr, inpptr, weightptr, biasptr, 0, 0,
+                         *params)
+
+
+def ppl_stage_l2(src, dst):
+    """Stage a global tensor (region) into an ``alloc_l2`` buffer once for all cores.
+
+    The cores copy disjoint channel slices and then wait for each other, so
+    afterwards every core can ``ppl_copy`` its tiles from L2 instead of
+    re-reading the operand from DDR.
+    """
+
+    def _to_region(data, access_type):
+        if isinstance(data, Buffer):
+            return buffer_to_tile_region(data, access_type)
+        return buffer_region_to_tile_region(data, access_type)
+
+    assert isinstance(dst, Buffer) and dst.scope() in ("shared.l2", "global.l2"), \
+        "ppl_stage_l2 writes a whole L2 buffer"
+    return T.call_extern("handle", "ppl.stage_l2", _to_region(src, "r"), _to_region(dst, "w"))
+
+
+# all_reduce_opcode_t of the TPU kernel API
+_ALL_REDUCE_OPCODES = {"prod": 1, "max": 2, "min": 3, "sum": 4}
+
+
+def _comm_region(data, access_type):
+    if isinstance(data, Buffer):
+        assert len(data.shape) == 2, "collectives take 2D [rows, cols] tensors"
+        return buffer_to_tile_region(data, access_type)
+    return buffer_region_to_tile_region(data, access_type)
+
+
+def ppl_all_reduce(buf, op="sum"):
+    """All-reduce a global [rows, cols] tensor in place across the chips of the job.
+
+    Lowered where it is written, e.g. on a block's tile in a GEMM epilogue.
+    Every core waits for its GDMA stores and meets the others, then each runs
+    the CDMA ring on its share of the columns; a second barrier makes the
+    reduced tile visible to all cores before the next statement. It does not
+    overlap with compute. On a single emulated chip it goes through the fake
+    CDMA entry points.
+    """
+    return T.call_extern("handle", "ppl.all_reduce", _comm_region(buf, "rw"),
+                         _ALL_REDUCE_OPCODES[op])
+
+
+def ppl_all_gather(src, dst):
+    """Gather every rank's ``src`` rows into ``dst``, rank r's rows being chunk r."""
+    return T.call_extern("handle", "ppl.all_gather", _comm_region(src, "r"),
+                         _comm_region(dst, "rw"))
+
+
+def ppl_reduce_scatter(src, dst, op="sum"):
+    """Reduce ``src`` across ranks and keep row chunk r in ``dst`` on rank r.
+
+    ``src`` is used as the ring workspace and holds partial results afterwards.
+    """
+    return T.call_extern("handle", "ppl.reduce_scatter", _comm_region(src, "rw"),
+                         _comm_region(dst, "w"), _ALL_REDUCE_OPCODES[op])
+
+
+def ppl_transpose(src, dst):
+    """Transpose a tile: 2D [M, N] -> [N, M], or swap dims 1 and 3 of a 4D tile.
+
+    Either side may be a global region, in which case the transpose is fused
+    into the GDMA load or store instead of costing a separate pass.
+    """
+
+    def get_extent(data):
+        if isinstance(data, Buffer):
+            return list(data.shape)
+        elif isinstance(data, BufferRegion):
+            return [x.extent for x in data.region]
+        raise ValueError(f"ppl_transpose expects a Buffer or BufferRegion, got {type(data)}")
+
+    def _to_region(data, access_type):
+        if isinstance(data, Buffer):
+            return buffer_to_tile_region(data, access_type)
+        return buffer_region_to_tile_region(data, access_type)
+
+    src_extent, dst_extent = get_extent(src), get_extent(dst)
+    if len(src_extent) == 2:
+        expected = [src_extent[1], src_extent[0]]
+    elif len(src_extent) == 4:
+        expected = [src_extent[0], src_extent[3], src_extent[2], src_extent[1]]
+    else:
+        raise ValueError(f"ppl_transpose supports 2D and 4D tiles, got {src_extent}")
+    assert len(dst_extent) == len(expected) and all(
+        int(a) == int(b) for a, b in zip(dst_extent, expected)
+    ), f"ppl_transpose shape mismatch: {src_extent} -> {dst_extent}"
+    return T.call_extern("handle", "ppl.transpose", _to_region(src, "r"), _to_region(dst, "w"))
+
+
 def ppl_fill(buffer, value):
     buffer = buffer.access_ptr("w")
     return T.call_extern("handle", "ppl.fill", buffer, value)
@@ -366,20 +640,54 @@ def rvv_mul(out, inp1, inp2):
     return T.call_extern("handle", "rvv.mul", outptr, inpptr1, inpptr2)
 
 
-@T.macro
+def rvv_rsqrt(out, inp):
+    inpptr = inp.access_ptr("r")
+    outptr = out.access_ptr("w")
+    return T.call_extern("handle", "rvv.rsqrt", outptr, inpptr)
+
+
+def _rvv_unary(name, out, inp):
+    inpptr = inp.access_ptr("r")
+    outptr = out.access_ptr("w")
+    return T.call_extern("handle", f"rvv.{name}", outptr, inpptr)
+
+
+def rvv_exp(out, inp):
+    """out = e ** inp"""
+    return _rvv_unary("exp", out, inp)
+
+
+def rvv_exp_base2(out, inp):
+    """out = 2 ** inp"""
+    return _rvv_unary("exp2", out, inp)
+
+
+@deprecated("T.rvv_exp2(out, work0, work1, coeff, table)", "T.rvv_exp(out, out)")
 def rvv_exp2(out, work0, work1, coeff, table):  # only support FP32
+    """out = e ** out in place, the work buffers are no longer used."""
     buffer = out.access_ptr("rw")
     work0ptr = work0.access_ptr("rw")
     work1ptr = work1.access_ptr("rw")
     coeffptr = coeff.access_ptr("rw")
     tableptr = table.access_ptr("rw")
-    T.call_extern("handle", "rvv.exp", buffer, work0ptr, work1ptr, coeffptr, tableptr)
+    return T.call_extern("handle", "rvv.exp", buffer, work0ptr, work1ptr, coeffptr, tableptr)
 
 
-def rvv_rsqrt(out, inp):
-    inpptr = inp.access_ptr("r")
-    outptr = out.access_ptr("w")
-    return T.call_extern("handle", "rvv.rsqrt", outptr, inpptr)
+def rvv_log(out, inp):
+    return _rvv_unary("log", out, inp)
+
+
+def rvv_tanh(out, inp):
+    return _rvv_unary("tanh", out, inp)
+
+
+def rvv_sigmoid(out, inp):
+    return _rvv_unary("sigmoid", out, inp)
+
+
+def rvv_gelu(out, inp):
+    """tanh approximated GELU."""
+    return _rvv_unary("gelu", out, inp)
 
 
 def rvv_add_C(out, inp1, value):
@@ -402,55 +710,25 @@ def rvv_div(out, inp1, inp2):
     return T.call_extern("handle", "rvv.div", outptr, inpptr1, inpptr2)
 
 
-@T.macro
-def rvv_reduce_sum_safe(inp, out, dim):
-    inpptr = inp.access_ptr("rw")
-    outptr = out.access_ptr("rw")
-    with T.block("reduce_sum"):
-        tmp_shape = [inp.shape[0], 32]  # EU数量为32
-        tmp_buffer_sum = T.alloc_shared(tmp_shape, inp.dtype)
-        tmp_ptr = tmp_buffer_sum.access_ptr("rw")
-        eu_num = T.int32(32)
-        channel = T.int32(64)
-        align_w = T.ceildiv(inp.shape[1], eu_num) * eu_num
-        stride = T.ceildiv(inp.shape[0], channel) * align_w
-        # 调用底层reduce_max实现a
-        T.call_extern("handle", "rvv.reduce_sum", inpptr, outptr, tmp_ptr, eu_num, align_w, stride)
+def _rvv_reduce(name, inp, out, dim, clear, ordered=False):
+    if dim < 0:
+        dim += len(inp.shape)
+    assert dim in (0, 1), "Only dim 0 (across rows) or 1 (along rows) is supported"
+    return T.call_extern("handle", name, inp.access_ptr("r"),
+                         out.access_ptr("w" if clear else "rw"), dim, int(clear), int(ordered))
 
 
-def rvv_reduce_sum(inp, out, dim):
-    assert dim == 1, "Only dim=1 is supported for reduction"
-    return rvv_reduce_sum_safe(inp, out, dim)
-
-
-@T.macro
-def rvv_reduce_max_safe(inp, out, dim, clear=True):
-    inpptr = inp.access_ptr("rw")
-    outptr = out.access_ptr("rw")
-    if clear:
-        T.call_extern("handle", "rvv.fill", outptr, T.float16(float('-inf')))
-    # 仅支持2D张量和dim=1
-    # assert len(shape) == 2, "Only 2D tensors are supported"
-    # 如果没有提供临时缓冲区，则创建一个
-    # 创建一个临时缓冲区用于中间结果
-    # 注意：这里的32是EU数量，可能需要根据实际情况调整
-    with T.block("reduce_max"):
-        tmp_shape = [inp.shape[0], 32]  # EU数量为32
-        tmp_buffer_max = T.alloc_shared(tmp_shape, inp.dtype)
-        tmp_ptr = tmp_buffer_max.access_ptr("rw")
-        eu_num = T.int32(32)
-        channel = T.int32(64)
-        align_w = T.ceildiv(inp.shape[1], eu_num) * eu_num
-        stride = T.ceildiv(inp.shape[0], channel) * align_w
-        # 调用底层reduce_max实现a
-        T.call_extern("handle", "rvv.reduce_max", inpptr, outptr, tmp_ptr, eu_num, align_w, stride)
+def rvv_reduce_sum(inp, out, dim, clear=True, ordered=False):
+    """out = sum of the 2-D tile inp along dim; with clear=False the sums are
+    added to out. ordered adds the elements of a float row strictly in order
+    (vfredosum) instead of as a tree."""
+    return _rvv_reduce("rvv.reduce_sum", inp, out, dim, clear, ordered)
 
 
 def rvv_reduce_max(inp, out, dim, clear=True):
-    # 在函数外部进行检查
-    assert dim == 1, "Only dim=1 is supported"
-    # 调用不含断言的宏函数
-    return rvv_reduce_max_safe(inp, out, dim, clear)
+    """out = max of the 2-D tile inp along dim; with clear=False the maxima
+    also cover the values already in out."""
+    return _rvv_reduce("rvv.reduce_max", inp, out, dim, clear)
 
 
 def rvv_embedding(out, param, index, outer_num, inner_num, select_num, index_num):
@@ -0,0 +1,141 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+"""Decoder for TPU kernels compiled with ``tl.ppl_profile``.
+
+With the pass config enabled, the PPL codegen brackets every ``ppl.*`` tile op
+with ``__ppl_prof_begin/end`` markers that record the BDC and GDMA command-id
+ranges issued by that op, and the kernel wrapper prints them after
+``tpu_poll()``::
+
+    [ppl_prof] stmt=3 bd=12:14 gdma=7:7 op=T.call_extern("handle", "ppl.gemm", ...)
+
+When the runtime is profiling (``ENABLE_PROFILE=1`` on the emulator) it also
+prints one record per retired command with its id and cycle count.  This module
+joins both streams, so the time of every command is attributed to the tilelang
+statement that issued it and to the engine that executed it.
+
+Example:
+    kernel = tilelang.compile(func, target="tpu", pass_configs={"tl.ppl_profile": True})
+    log = ...  # stdout of the launch, see benchmark/tpu/tpu_bench_utils.py
+    print(format_ppl_profile(decode_ppl_profile(log)))
+"""
+
+import re
+from dataclasses import dataclass, field
+from typing import Dict, List, Optional, Tuple
+
+_MARKER_RE = re.compile(r"\[ppl_prof\] stmt=(?P<stmt>\d+) bd=(?P<bd0>\d+):(?P<bd1>\d+) "
+                        r"gdma=(?P<gdma0>\d+):(?P<gdma1>\d+) op=(?P<op>.*)$")
+_SUMMARY_RE = re.compile(r"\[ppl_prof\] records=(?P<num>\d+) dropped=(?P<dropped>\d+)")
+_RECORD_RE = re.compile(r"---> (?P<engine>bdc|gdma) record #\d+, inst_id=(?P<inst>\d+), "
+                        r"thread_id=\d+, cycle=(?P<cycle>\d+), start=(?P<start>[-\d.]+)us, "
+                        r"end=(?P<end>[-\d.]+)us")
+_OP_NAME_RE = re.compile(r"\"(ppl\.[A-Za-z0-9_]+)\"")
+
+ENGINES = ("bdc", "gdma")
+
+
+@dataclass
+class StmtProfile:
+    """Accumulated cost of one profiled tile statement over all its executions."""
+    stmt: int
+    op: str
+    text: str
+    count: int = 0
+    instructions: Dict[str, int] = field(default_factory=lambda: {e: 0 for e in ENGINES})
+    cycles: Dict[str, int] = field(default_factory=lambda: {e: 0 for e in ENGINES})
+    time_us: Dict[str, float] = field(default_factory=lambda: {e: 0.0 for e in ENGINES})
+
+    @property
+    def total_cycles(self) -> int:
+        return sum(self.cycles.values())
+
+
+@dataclass
+class PPLProfile:
+    stmts: List[StmtProfile]
+    dropped: int = 0
+    # commands the runtime reported but no marker range covered (e.g. tpu_poll)
+    unattributed_cycles: Dict[str, int] = field(default_factory=lambda: {e: 0 for e in ENGINES})
+
+
+def _parse_engine_records(lines: List[str]) -> Dict[str, Dict[int, Tuple[int, float]]]:
+    records: Dict[str, Dict[int, Tuple[int, float]]] = {e: {} for e in ENGINES}
+    for line in lines:
+        m = _RECORD_RE.search(line)
+        if m:
+            duration = float(m.group("end")) - float(m.group("start"))
+            records[m.group("engine")][int(m.group("inst"))] = (int(m.group("cycle")), duration)
+    return records
+
+
+def decode_ppl_profile(log: str) -> PPLProfile:
+    """Join ``[ppl_prof]`` markers with the runtime command records in ``log``.
+
+    Command ids are compared on half-open ``[begin, end)`` ranges: the id node
+    holds the id of the *next* command, so a range issued by one op ends where
+    the next op's begins.
+    """
+    lines = log.splitlines()
+    engine_records = _parse_engine_records(lines)
+    stmts: Dict[int, StmtProfile] = {}
+    claimed = {e: set() for e in ENGINES}
+    dropped = 0
+    for line in lines:
+        m = _SUMMARY_RE.search(line)
+        if m:
+            dropped += int(m.group("dropped"))
+            continue
+        m = _MARKER_RE.search(line)
+        if not m:
+            continue
+        stmt_id = int(m.group("stmt"))
+        prof = stmts.get(stmt_id)
+        if prof is None:
+            text = m.group("op").strip()
+            name = _OP_NAME_RE.search(text)
+            prof = stmts[stmt_id] = StmtProfile(stmt_id, name.group(1) if name else text, text)
+        prof.count += 1
+        ranges = {
+            "bdc": (int(m.group("bd0")), int(m.group("bd1"))),
+            "gdma": (int(m.group("gdma0")), int(m.group("gdma1"))),
+        }
+        for engine, (begin, end) in ranges.items():
+            prof.instructions[engine] += max(end - begin, 0)
+            for inst in range(begin, end):
+                rec = engine_records[engine].get(inst)
+                if rec is None:
+                    continue
+                prof.cycles[engine] += rec[0]
+                prof.time_us[engine] += rec[1]
+                claimed[engine].add(inst)
+
+    result = PPLProfile(sorted(stmts.values(), key=lambda s: s.stmt), dropped)
+    for engine in ENGINES:
+        result.unattributed_cycles[engine] = sum(
+            cycle for inst, (cycle, _) in engine_records[engine].items()
+            if inst not in claimed[engine])
+    return result
+
+
+def format_ppl_profile(profile: PPLProfile, top: Optional[int] = None, width: int = 72) -> str:
+    """Render a per-statement table sorted by total cycles."""
+    total = sum(s.total_cycles for s in profile.stmts) or 1
+    rows = sorted(profile.stmts, key=lambda s: s.total_cycles, reverse=True)
+    if top is not None:
+        rows = rows[:top]
+    out = [
+        f"{'stmt':>4} {'op':<18}{'calls':>7}{'bdc inst':>10}{'bdc cyc':>12}"
+        f"{'gdma inst':>11}{'gdma cyc':>12}{'share':>8}  source"
+    ]
+    for s in rows:
+        text = s.text if len(s.text) <= width else s.text[:width - 3] + "..."
+        out.append(f"{s.stmt:>4} {s.op:<18}{s.count:>7}{s.instructions['bdc']:>10}"
+                   f"{s.cycles['bdc']:>12}{s.instructions['gdma']:>11}{s.cycles['gdma']:>12}"
+                   f"{100.0 * s.total_cycles / total:>7.1f}%  {text}")
+    if any(profile.unattributed_cycles.values()):
+        out.append(f"unattributed cycles: bdc={profile.unattributed_cycles['bdc']} "
+                   f"gdma={profile.unattributed_cycles['gdma']}")
+    if profile.dropped:
+        out.append(f"warning: {profile.dropped} marker records dropped (profile buffer full)")
+    return "\n".join(out)
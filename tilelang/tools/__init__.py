@@ -2,3 +2,4 @@
 # Licensed under the MIT License.
 
 from .plot_layout import plot_layout  # noqa: F401
+from .plot_memory_plan import get_memory_plan, format_memory_plan, plot_memory_plan  # noqa: F401
@@ -0,0 +1,187 @@
+# Copyright (c) Tile-AI Corporation.
+# Licensed under the MIT License.
+
+from typing import Any, Dict, Union
+
+import tvm
+from tvm import tir
+
+MEMORY_PLAN_ATTR = "tl.memory_plan"
+
+
+def _to_python(obj: Any) -> Any:
+    """Convert the TVM containers of a memory plan into plain Python values."""
+    if isinstance(obj, (tvm.ir.container.Map, dict)):
+        return {str(k): _to_python(v) for k, v in obj.items()}
+    if isinstance(obj, (tvm.ir.container.Array, list, tuple)):
+        return [_to_python(v) for v in obj]
+    if isinstance(obj, tvm.tir.IntImm):
+        return bool(obj.value) if obj.dtype == "bool" else int(obj.value)
+    if isinstance(obj, tvm.runtime.String):
+        return str(obj)
+    return obj
+
+
+def get_memory_plan(obj) -> Dict[str, Any]:
+    """
+    Return the local memory plan the AddressAssign pass recorded for a TPU kernel.
+
+    Parameters
+    ----------
+    obj : CompiledArtifact, tvm.IRModule or tir.PrimFunc
+        The result of ``tilelang.lower(func, target="tpu")`` or its lowered module.
+
+    Returns
+    -------
+    dict
+        ``buffers`` lists every local buffer with its ``addr`` (-1 if it did not
+        fit), ``size`` in bytes per NPU, ``bank_start``/``bank_end`` and
+        ``live_start``/``live_end`` in statement steps. The totals ``capacity``,
+        ``used``, ``buffer_bytes``, ``banks_used``, ``peak_bytes`` and
+        ``peak_buffers`` describe the whole kernel; ``l2_buffers`` lists the
+        L2 SRAM placement.
+
+        Addresses and banks are the allocator's. The live intervals and the
+        peak are estimated from the statement order (``live_estimated``): the
+        allocator itself keeps every buffer live for the whole kernel and
+        never lets two buffers share memory.
+    """
+    if hasattr(obj, "device_mod"):
+        obj = obj.device_mod
+    if isinstance(obj, tvm.IRModule):
+        funcs = [f for _, f in obj.functions.items() if isinstance(f, tir.PrimFunc)]
+    else:
+        funcs = [obj]
+    for func in funcs:
+        if func.attrs is not None and MEMORY_PLAN_ATTR in func.attrs:
+            return _to_python(func.attrs[MEMORY_PLAN_ATTR])
+    raise ValueError("No memory plan found, was the kernel lowered with AddressAssign?")
+
+
+def _estimated(plan: Dict[str, Any]) -> str:
+    return "estimated " if plan.get("live_estimated") else ""
+
+
+def format_memory_plan(plan: Dict[str, Any]) -> str:
+    """Render a memory plan as a table, largest buffers first."""
+    lines = [
+        f"local memory: {plan['used']} / {plan['capacity']} bytes used, "
+        f"{plan['buffer_bytes']} bytes in buffers, "
+        f"{plan['banks_used']} / {plan['bank_num']} banks",
+        f"{_estimated(plan)}peak live: {plan['peak_bytes']} bytes at step {plan['peak_step']} "
+        f"({', '.join(plan['peak_buffers'])})",
+    ]
+    if not plan["success"]:
+        lines.append("placement FAILED, buffers with addr -1 did not fit")
+    live_header = "live (est.)" if plan.get("live_estimated") else "live"
+    lines.append(f"{'buffer':<24}{'addr':>10}{'size':>10}{'banks':>10}{live_header:>12}")
+    for buf in sorted(plan["buffers"], key=lambda b: -b["size"]):
+        banks = (f"{buf['bank_start']}-{buf['bank_end']}" if "bank_start" in buf else "-")
+        live = f"{buf['live_start']}-{buf['live_end']}"
+        lines.append(f"{buf['name']:<24}{buf['addr']:>10}{buf['size']:>10}{banks:>10}{live:>12}")
+    for buf in plan["l2_buffers"]:
+        lines.append(f"{buf['name']:<24}{'L2+' + str(buf['addr']):>10}{buf['size']:>10}")
+    return "\n".join(lines)
+
+
+def plot_memory_plan(plan: Union[Dict[str, Any], Any],
+                     save_directory="./tmp",
+                     name: str = "memory_plan",
+                     colormap: str = "tab20",
+                     verbose: bool = False) -> None:
+    """
+    Plot the local memory banks of a TPU kernel over time.
+
+    Every buffer is drawn over the banks it occupies and the statement steps it
+    is live; the step with the most live bytes is marked, its buffers are the
+    ones that limit a larger tile. The banks are the allocator's, the live
+    steps an estimate, see ``get_memory_plan``.
+
+    Parameters
+    ----------
+    plan : dict or CompiledArtifact/IRModule/PrimFunc
+        A plan from ``get_memory_plan`` or anything it accepts.
+    save_directory : str, optional
+        The directory where the output images will be saved (default is "./tmp").
+    name : str, optional
+        The base name of the output files (default is "memory_plan").
+    colormap : str, optional
+        The colormap to use for the buffers (default is "tab20").
+    verbose : bool, optional
+        If True, prints the plan as a table (default is False).
+
+    Returns
+    -------
+    None
+    """
+    import os
+    import pathlib
+    import matplotlib.pyplot as plt
+    import matplotlib.patches as patches
+
+    if not isinstance(plan, dict):
+        plan = get_memory_plan(plan)
+    if verbose:
+        print(format_memory_plan(plan))
+
+    bank_num = plan["bank_num"]
+    bank_size = plan["bank_size"]
+    steps = max(plan["steps"], 1)
+    buffers = [b for b in plan["buffers"] if b["addr"] >= 0]
+    cmap = plt.get_cmap(colormap, max(len(buffers), 1))
+
+    plt.figure(figsize=(max(8, min(steps, 40) * 0.4), bank_num * 0.5))
+    ax = plt.gca()
+    for i, buf in enumerate(buffers):
+        # the exact byte range, in units of banks
+        y = buf["addr"] / bank_size
+        height = max(buf["size"], 1) / bank_size
+        x = buf["live_start"]
+        width = buf["live_end"] - buf["live_start"] + 1
+        rect = patches.Rectangle((x, y),
+                                 width,
+                                 height,
+                                 linewidth=0.5,
+                                 edgecolor='black',
+                                 facecolor=cmap(i),
+                                 alpha=0.8)
+        ax.add_patch(rect)
+        ax.text(x + width / 2, y + height / 2, buf["name"], ha='center', va='center', fontsize=8)
+
+    ax.axvline(plan["peak_step"] + 0.5, color='red', linestyle='--', linewidth=1)
+    ax.set_xlim(0, steps)
+    ax.set_ylim(0, bank_num)
+    ax.set_yticks(range(bank_num))
+    ax.set_xlabel("statement step, estimated liveness"
+                  if plan.get("live_estimated") else "statement step")
+    ax.set_ylabel("bank")
+    ax.grid(axis='y', linestyle=':', linewidth=0.5)
+    title = (f"{plan['used']} / {plan['capacity']} B used, "
+             f"{_estimated(plan)}peak live {plan['peak_bytes']} B at step {plan['peak_step']}")
+    if not plan["success"]:
+        unplaced = [b["name"] for b in plan["buffers"] if b["addr"] < 0]
+        title += f"\nnot placed: {', '.join(unplaced)}"
+    ax.set_title(title)
+
+    # Create the output directory if it does not exist
+    tmp_directory = pathlib.Path(save_directory)
+    if not os.path.exists(tmp_directory):
+        os.makedirs(tmp_directory)
+
+    plt.tight_layout()
+
+    # Save as PDF
+    pdf_path = tmp_directory / f"{name}.pdf"
+    plt.savefig(pdf_path, bbox_inches="tight")
+    print(f"Saved pdf format into {pdf_path}")
+
+    # Save as PNG
+    png_path = tmp_directory / f"{name}.png"
+    plt.savefig(png_path, bbox_inches="tight", transparent=False, dpi=255)
+    print(f"Saved png format into {png_path}")
+
+    # Save as SVG
+    svg_path = tmp_directory / f"{name}.svg"
+    plt.savefig(svg_path, bbox_inches="tight", format="svg")
+    print(f"Saved svg format into {svg_path}")
+    plt.close()
@@ -62,6 +62,35 @@ def InjectSoftwarePipeline():
     return _ffi_api.InjectSoftwarePipeline()  # type: ignore
 
 
+def FusePPLElementwise():
+    """FusePPLElementwise
+
+    Fuse chains of ppl.* elementwise tile ops: fold constant operands into the
+    scalar variants, run chains in place on the final destination and share
+    the scratch buffers of ppl.exp, dropping the temporaries left unused.
+
+    Returns
+    -------
+    fpass : tvm.transform.Pass
+        The result pass
+    """
+    return _ffi_api.FusePPLElementwise()  # type: ignore
+
+
+def UnrollPipelineVersions():
+    """UnrollPipelineVersions
+
+    Unroll pipelined loops by the number of versions of their multi-versioned
+    buffers, so that the version selected in each iteration is static.
+
+    Returns
+    -------
+    fpass : tvm.transform.Pass
+        The result pass
+    """
+    return _ffi_api.UnrollPipelineVersions()  # type: ignore
+
+
 def FrontendLegalize():
     """FrontendLegalize
 
@@ -1,7 +1,7 @@
 # Copyright (c) Tile-AI Corporation.
 # Licensed under the MIT License.
 
-from typing import Literal, Union
+from typing import Dict, Literal, Tuple, Union
 from tilelang import tvm as tvm
 from tvm.target import Target
 from tvm.contrib import rocm
@@ -19,6 +19,22 @@ AVALIABLE_TARGETS = {
 }
 
 
+def parse_target_options(target: str) -> Tuple[str, Dict[str, str]]:
+    """
+    Split a target string such as ``"rvv -vlen=256"`` into its kind and options.
+
+    Returns:
+        Tuple[str, Dict[str, str]]: ``("rvv", {"vlen": "256"})``; an option without
+        a value maps to ``"true"``.
+    """
+    kind, *opts = target.split()
+    options = {}
+    for opt in opts:
+        name, _, value = opt.lstrip("-").partition("=")
+        options[name] = value or "true"
+    return kind, options
+
+
 def check_cuda_availability() -> bool:
     """
     Check if CUDA is available on the system by locating the CUDA path.
@@ -79,8 +95,8 @@ def determine_target(target: Union[str, Target, Literal["auto"]] = "auto",
             raise ValueError("No CUDA or HIP available on this system.")
     else:
         # Validate the target if it's not "auto"
-        assert isinstance(
-            target, Target) or target in AVALIABLE_TARGETS, f"Target {target} is not supported"
+        assert isinstance(target, Target) or parse_target_options(
+            target)[0] in AVALIABLE_TARGETS, f"Target {target} is not supported"
         return_var = target
 
     if return_object: